@@ -1,7 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
-#include <HardwareSerial.h>
+#include <RS485Port.h>
 
 // Unit Roller485 Motor Control Commands and Registers
 enum MotorMode {
@@ -67,7 +67,7 @@ struct MotorConfig {
 
 class UnitRoller485Controller {
 private:
-    HardwareSerial* _serial;
+    RS485Port _port;  // RS485 half-duplex UART, DE driven by hardware
     uint8_t _motorId;
     MotorStatus _status;
     MotorConfig _config;
@@ -76,22 +76,20 @@ private:
     uint32_t _baudRate;
     uint8_t _rxPin;
     uint8_t _txPin;
-    uint8_t _dePin;  // Direction enable pin for RS485
+    uint8_t _dePin;  // Direction enable pin for RS485 (UART RTS)
     
     // Internal methods
     bool sendCommand(uint8_t reg, uint32_t value);
     bool readRegister(uint8_t reg, uint32_t& value);
     bool writeRegister(uint8_t reg, uint32_t value);
     uint16_t calculateCRC(uint8_t* data, uint8_t length);
-    void enableTransmit();
-    void enableReceive();
     
 public:
     UnitRoller485Controller(uint8_t motorId = 1);
     ~UnitRoller485Controller();
     
     // Initialization
-    bool begin(HardwareSerial* serial, uint32_t baudRate = 115200, 
+    bool begin(uart_port_t port = UART_NUM_2, uint32_t baudRate = 115200, 
                uint8_t rxPin = 18, uint8_t txPin = 17, uint8_t dePin = 19);
     bool isConnected();
     
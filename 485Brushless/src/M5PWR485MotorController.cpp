@@ -11,7 +11,7 @@
 #define FUNC_WRITE_MULTIPLE_REGISTERS 0x10
 
 UnitRoller485Controller::UnitRoller485Controller(uint8_t motorId) 
-    : _motorId(motorId), _serial(nullptr), _baudRate(115200), 
+    : _motorId(motorId), _baudRate(115200), 
       _rxPin(18), _txPin(17), _dePin(19) {
     // Initialize status
     _status = {false, MODE_DISABLE, DIR_CW, 0.0, 0, 0.0, 0.0, 0, 0, false};
@@ -21,25 +21,27 @@ UnitRoller485Controller::UnitRoller485Controller(uint8_t motorId)
 }
 
 UnitRoller485Controller::~UnitRoller485Controller() {
-    if (_serial) {
-        _serial->end();
-    }
+    _port.end();
 }
 
-bool UnitRoller485Controller::begin(HardwareSerial* serial, uint32_t baudRate, 
+bool UnitRoller485Controller::begin(uart_port_t port, uint32_t baudRate, 
                                     uint8_t rxPin, uint8_t txPin, uint8_t dePin) {
-    _serial = serial;
     _baudRate = baudRate;
     _rxPin = rxPin;
     _txPin = txPin;
     _dePin = dePin;
     
-    // Configure DE pin for RS485 direction control
-    pinMode(_dePin, OUTPUT);
-    enableReceive();
+    // UART in RS485 half-duplex mode drives DE from RTS
+    RS485Port::Config config;
+    config.port = port;
+    config.txPin = _txPin;
+    config.rxPin = _rxPin;
+    config.dePin = _dePin;
+    config.baudRate = _baudRate;
     
-    // Initialize serial communication
-    _serial->begin(_baudRate, SERIAL_8N1, _rxPin, _txPin);
+    if (!_port.begin(config)) {
+        return false;
+    }
     delay(100);
     
     // Test connection
@@ -50,16 +52,6 @@ bool UnitRoller485Controller::isConnected() {
     return updateStatus();
 }
 
-void UnitRoller485Controller::enableTransmit() {
-    digitalWrite(_dePin, HIGH);
-    delayMicroseconds(50);
-}
-
-void UnitRoller485Controller::enableReceive() {
-    digitalWrite(_dePin, LOW);
-    delayMicroseconds(50);
-}
-
 uint16_t UnitRoller485Controller::calculateCRC(uint8_t* data, uint8_t length) {
     uint16_t crc = 0xFFFF;
     
@@ -94,22 +86,12 @@ bool UnitRoller485Controller::writeRegister(uint8_t reg, uint32_t value) {
     frame[6] = crc & 0xFF;
     frame[7] = (crc >> 8) & 0xFF;
     
-    // Send frame
-    enableTransmit();
-    _serial->write(frame, 8);
-    _serial->flush();
-    enableReceive();
+    // Send frame (bus turnaround handled by the UART)
+    _port.write(frame, 8);
     
     // Wait for response
-    uint32_t startTime = millis();
     uint8_t response[8];
-    uint8_t responseIndex = 0;
-    
-    while (millis() - startTime < MAX_RESPONSE_TIME && responseIndex < 8) {
-        if (_serial->available()) {
-            response[responseIndex++] = _serial->read();
-        }
-    }
+    int responseIndex = _port.read(response, sizeof(response), pdMS_TO_TICKS(MAX_RESPONSE_TIME));
     
     // Verify response (should echo the command for successful write)
     if (responseIndex >= 8) {
@@ -137,22 +119,12 @@ bool UnitRoller485Controller::readRegister(uint8_t reg, uint32_t& value) {
     frame[6] = crc & 0xFF;
     frame[7] = (crc >> 8) & 0xFF;
     
-    // Send frame
-    enableTransmit();
-    _serial->write(frame, 8);
-    _serial->flush();
-    enableReceive();
+    // Send frame (bus turnaround handled by the UART)
+    _port.write(frame, 8);
     
     // Wait for response
-    uint32_t startTime = millis();
     uint8_t response[7];  // ID + FUNC + COUNT + DATA(2) + CRC(2)
-    uint8_t responseIndex = 0;
-    
-    while (millis() - startTime < MAX_RESPONSE_TIME && responseIndex < 7) {
-        if (_serial->available()) {
-            response[responseIndex++] = _serial->read();
-        }
-    }
+    int responseIndex = _port.read(response, sizeof(response), pdMS_TO_TICKS(MAX_RESPONSE_TIME));
     
     // Verify and parse response
     if (responseIndex >= 7 && response[0] == _motorId && response[1] == FUNC_READ_HOLDING_REGISTER) {
@@ -11,7 +11,7 @@
 #define WEB_SERVER_PORT 80
 
 // Pin assignments for M5Stack Station 485
-// PWR485 uses the built-in RS485 transceiver (Serial2)
+// PWR485 uses the built-in RS485 transceiver (UART2, DE driven by the UART)
 #define RS485_RX_PIN 16   // PWR485 RX (GPIO16/U2RXD)
 #define RS485_TX_PIN 17   // PWR485 TX (GPIO17/U2TXD) 
 #define RS485_DE_PIN 19   // PWR485 DE (GPIO19) - Direction Enable
@@ -154,7 +154,7 @@ void setup() {
     
     // Try RS485 initialization if not in I2C mode
     if (!useI2CMode) {
-        if (motorController.begin(&Serial2, 115200, RS485_RX_PIN, RS485_TX_PIN, RS485_DE_PIN)) {
+        if (motorController.begin(UART_NUM_2, 115200, RS485_RX_PIN, RS485_TX_PIN, RS485_DE_PIN)) {
             Serial.println("Unit Roller485 controller initialized successfully");
             M5.Display.drawString("Motor: OK", 10, 40);
             
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * Host-side checks and microbenchmarks behind the native build's --bench
+ *
+ * Each suite prints its own table. The parser suite also checks decoded
+ * output against expected frames first; run() returns false if any check
+ * failed, so --bench can gate a host build.
+ */
+namespace Benchmarks {
+    bool run();
+
+    // CrestronFrameParser: split, merged and corrupted input, then bytes/s
+    bool runParserSuite();
+
+    // Submitting a TX frame to the TX task: copied Messages through a queue
+    // (the original design) against pooled buffers passed by pointer
+    void runTxPathBench();
+
+    // Per-ping slave bookkeeping: std::map against SlaveTable
+    void runSlaveTableBench();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+/**
+ * Ring buffer of timestamped bus frames for offline analysis
+ *
+ * Both the TX and RX tasks record into it, so record() takes a short spinlock
+ * around the copy. When full the oldest frames are dropped. The buffer is
+ * allocated in PSRAM when the board has it, otherwise a smaller block of
+ * internal RAM is used.
+ *
+ * Dump format (all fields little-endian):
+ *   header:  u32 magic "RCAP", u8 version, u8 reserved, u16 reserved,
+ *            u32 baud rate, u32 record count, u32 record bytes
+ *   record:  u32 timestamp (esp_timer us, low 32 bits), u8 flags, u8 length,
+ *            length data bytes
+ *   flags:   bit 0 = received (else transmitted), bit 1 = line break appended
+ */
+class BusCapture {
+public:
+    static constexpr uint32_t FILE_MAGIC = 0x50414352;   // "RCAP"
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint8_t FLAG_RX = 0x01;
+    static constexpr uint8_t FLAG_BREAK = 0x02;
+    static constexpr size_t FILE_HEADER_SIZE = 5 * sizeof(uint32_t);
+
+    BusCapture();
+    ~BusCapture();
+
+    // Allocates the buffer; recording stays off until setEnabled(true)
+    bool begin(size_t psramBytes, size_t internalBytes);
+    void end();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+    bool inPsram() const { return m_inPsram; }
+
+    void record(uint8_t flags, int64_t timestampUs, const uint8_t* data, size_t length);
+    void clear();
+
+    // Writes header and records in capture order; recording pauses meanwhile
+    size_t dump(Print& out, uint32_t baudRate);
+
+    size_t getCapacity() const { return m_capacity; }
+    size_t getUsedBytes() const { return m_used; }
+    // Bytes dump() writes while recording is paused
+    size_t getDumpSize() const { return FILE_HEADER_SIZE + m_used; }
+    uint32_t getRecordCount() const { return m_recordCount; }
+    uint32_t getDroppedCount() const { return m_droppedCount; }
+
+private:
+    static constexpr size_t RECORD_HEADER_SIZE = 6;
+
+    uint8_t* m_buffer;
+    size_t m_capacity;
+    size_t m_head;          // Next byte written
+    size_t m_tail;          // Oldest record
+    size_t m_used;
+    uint32_t m_recordCount;
+    uint32_t m_droppedCount;
+    volatile bool m_enabled;
+    bool m_inPsram;
+    portMUX_TYPE m_lock;
+
+    void writeBytes(const uint8_t* data, size_t length);
+    uint8_t byteAt(size_t offset) const;
+    void dropOldest();
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ConfigSequences.h"
+#include "config.h"
+
+/**
+ * TDMA slot table for one bus
+ *
+ * SlaveManager's slot timer walks SLOTS in a loop, and each slot decides what
+ * the master puts on the wire while it lasts:
+ *   POLL     one ping or discovery probe, its reply window and, after a
+ *            miss, the break
+ *   COMMAND  one DIM/DIMU frame, or a configuration step if no level is
+ *            pending
+ *   CONFIG   one configuration step, or a DIM/DIMU frame if no slave is
+ *            configuring
+ * A slot ends a guard time after its frame has left the wire, so the lengths
+ * here are upper bounds, not a fixed cadence. A whole cycle with nothing to
+ * do runs at full length, leaving the bus idle.
+ *
+ * Slot lengths follow from the bus's baud rate and reply timeout, so the
+ * same table serves any bus speed. Everything here is constexpr.
+ */
+namespace BusSchedule {
+    enum class SlotKind : uint8_t {
+        POLL,
+        COMMAND,
+        CONFIG
+    };
+
+    // What a slot was actually used for, for the statistics
+    enum class SlotUse : uint8_t {
+        POLL,
+        PROBE,
+        COMMAND,
+        CONFIG,
+        IDLE,
+        COUNT
+    };
+
+    constexpr SlotKind SLOTS[] = {
+        SlotKind::POLL,
+        SlotKind::COMMAND,
+        SlotKind::POLL,
+        SlotKind::CONFIG,
+    };
+    constexpr size_t SLOT_COUNT = sizeof(SLOTS) / sizeof(SLOTS[0]);
+
+    constexpr uint32_t BITS_PER_CHARACTER = 11;    // Start, 8 data, 2 stop
+    constexpr uint32_t GUARD_US = 500;             // Turnaround and task wake-up margin per slot
+
+    constexpr size_t PING_FRAME_LENGTH = 2;        // [addr] [0x00]
+    // DIMU with every channel: [addr] [len] [0x20] [0x01] [inner len] [0x1D] [0x00] entries...
+    constexpr size_t MAX_LEVEL_FRAME_LENGTH =
+        7 + CrestronProtocol::MAX_LEVELS_PER_FRAME * CrestronProtocol::DIM_ENTRY_LENGTH;
+
+    // Longest step of a sequence, address byte included
+    constexpr size_t longestFrame(const ConfigSequences::Sequence& sequence) {
+        size_t longest = 0;
+        for (size_t i = 0; i < sequence.count; i++) {
+            if (sequence.steps[i].length + 1u > longest) longest = sequence.steps[i].length + 1u;
+        }
+        return longest;
+    }
+
+    constexpr size_t maxOf(size_t a, size_t b) { return a > b ? a : b; }
+
+    // COMMAND and CONFIG slots are interchangeable, so both fit either frame
+    constexpr size_t DATA_FRAME_LENGTH = maxOf(MAX_LEVEL_FRAME_LENGTH,
+        maxOf(longestFrame(ConfigSequences::DIM8),
+              maxOf(longestFrame(ConfigSequences::DIMU8), longestFrame(ConfigSequences::IO48))));
+
+    constexpr uint32_t characterUs(uint32_t baudRate) {
+        return (BITS_PER_CHARACTER * 1000000UL + baudRate - 1) / baudRate;
+    }
+
+    constexpr uint32_t slotLengthUs(SlotKind kind, uint32_t baudRate, uint32_t pingTimeoutUs) {
+        return kind == SlotKind::POLL
+            ? PING_FRAME_LENGTH * characterUs(baudRate) + pingTimeoutUs +
+              CrestronTiming::BREAK_DURATION_US + GUARD_US
+            : DATA_FRAME_LENGTH * characterUs(baudRate) + GUARD_US;
+    }
+
+    constexpr bool hasPollSlot() {
+        for (size_t i = 0; i < SLOT_COUNT; i++) {
+            if (SLOTS[i] == SlotKind::POLL) return true;
+        }
+        return false;
+    }
+    static_assert(hasPollSlot(), "Slot table never polls");
+    static_assert(SLOT_COUNT <= UINT8_MAX, "Slot index must fit a byte");
+}
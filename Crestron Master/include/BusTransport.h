@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+/**
+ * Byte transport underneath RS485Communication
+ *
+ * Mirrors the ESP32 UART driver's model: the receive side reports DATA events
+ * with a byte count and a frameEnd flag once the line has been idle for the
+ * bus's RX idle timeout; the bytes are then fetched with read(). The transmit
+ * side queues bytes without waiting for the wire, and waitTxDone() blocks
+ * until the last stop bit has left. Implementations: Esp32UartTransport on
+ * the target, PtyTransport for the native (Linux) build.
+ */
+class BusTransport {
+public:
+    enum class EventType : uint8_t {
+        DATA,
+        FIFO_OVERFLOW,
+        BUFFER_FULL,
+        FRAME_ERROR,
+        PARITY_ERROR,
+        OTHER
+    };
+
+    struct Event {
+        EventType type;
+        size_t size;        // DATA: bytes ready to read()
+        bool frameEnd;      // DATA: line went idle after these bytes
+    };
+
+    virtual ~BusTransport() {}
+
+    virtual bool open(const BusSettings& settings) = 0;
+    virtual void close() = 0;
+
+    // Reception (one reader task)
+    virtual bool waitEvent(Event& event, TickType_t timeout) = 0;
+    virtual int read(uint8_t* buffer, size_t length) = 0;
+    virtual void flushInput() = 0;           // Drop buffered bytes
+    virtual void discardInput() = 0;         // Drop buffered bytes and pending events
+
+    // Transmission (one writer task)
+    virtual int write(const uint8_t* data, size_t length) = 0;
+    virtual int writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) = 0;
+    virtual bool waitTxDone(TickType_t timeout) = 0;
+    virtual bool collisionDetected() = 0;
+
+    virtual uint32_t characterTimeUs() const = 0;
+};
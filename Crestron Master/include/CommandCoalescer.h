@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+/**
+ * Pending dimmer levels, one entry per (address, channel)
+ *
+ * Posting a level for a channel that already has one waiting replaces it in
+ * place (last writer wins) and keeps its place in line, so a slider sweeping
+ * through fifty levels costs one frame carrying the newest. Entries are handed
+ * out oldest-first. Any task may post; a single task takes. A short spinlock
+ * guards the table, as in BusCapture.
+ */
+class CommandCoalescer {
+public:
+    enum class Kind : uint8_t {
+        DIM,
+        DIMU
+    };
+
+    struct Entry {
+        Kind kind;
+        uint8_t address;
+        uint8_t channel;
+        uint8_t level;
+        uint16_t rampTime;
+        uint16_t tag;       // Nonzero for a scene recall; copied onto the frame
+    };
+
+    // A full scene plus as many unrelated levels still waiting
+    static constexpr size_t CAPACITY = 2 * SceneConfig::MAX_TARGETS;
+
+    CommandCoalescer();
+
+    // False only when a new channel arrives with the table full
+    bool post(const Entry& entry);
+
+    // Oldest pending entry plus the later ones for the same address and kind,
+    // up to maxCount, in posting order; returns how many were taken
+    size_t takeBatch(Entry* entries, size_t maxCount);
+
+    // Put back an entry that could not be sent; a newer level posted since
+    // take() wins over it
+    void restore(const Entry& entry);
+    void restoreBatch(const Entry* entries, size_t count);
+
+    // Level waiting for the channel, if any
+    bool pendingLevel(uint8_t address, uint8_t channel, uint8_t& level) const;
+
+    size_t pending() const { return m_count; }
+
+    // Statistics
+    uint32_t getPostedCount() const { return m_postedCount; }
+    uint32_t getCoalescedCount() const { return m_coalescedCount; }
+    uint32_t getTakenCount() const { return m_takenCount; }
+    uint32_t getRejectedCount() const { return m_rejectedCount; }
+
+private:
+    Entry m_entries[CAPACITY];
+    volatile size_t m_count;
+    mutable portMUX_TYPE m_lock;
+
+    volatile uint32_t m_postedCount;
+    volatile uint32_t m_coalescedCount;
+    volatile uint32_t m_takenCount;
+    volatile uint32_t m_rejectedCount;
+
+    size_t findLocked(uint8_t address, uint8_t channel) const;
+};
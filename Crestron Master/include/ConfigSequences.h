@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Bring-up sequences sent to a slave after it requests configuration
+ *
+ * Transcribed from the dimSetup / dimUSetup arrays in example.ino. Frames are
+ * stored without the leading address byte (it is filled in per slave), so
+ * each one starts with its length byte. Everything here is constexpr and ends
+ * up in flash.
+ *
+ * settleMs is the minimum time before the slave's next step. The slave keeps
+ * being polled in the meantime, as example.ino does between steps; the long
+ * settle after the first step covers the run of pings example.ino sends while
+ * the dimmer restarts.
+ */
+namespace ConfigSequences {
+    struct Step {
+        const uint8_t* frame;
+        uint8_t length;
+        uint16_t settleMs;
+    };
+
+    struct Sequence {
+        const Step* steps;
+        size_t count;
+    };
+
+    // Shared by all device types
+    constexpr uint8_t CONFIG_START[] = {0x02, 0x03, 0x00};
+    constexpr uint8_t CONFIG_END[] = {0x02, 0x03, 0x16};
+    // Fixed date/time placeholder, as example.ino sends
+    constexpr uint8_t TIME_SYNC[] = {0x08, 0x08, 0x0E, 0x15, 0x45, 0x29, 0x05, 0x20, 0x20};
+
+    constexpr uint16_t STEP_MS = 2;             // CrestronTiming::CONFIG_STEP_DELAY_MS
+    constexpr uint16_t POLL_GAP_MS = 8;         // Steps followed by a ping in example.ino
+    constexpr uint16_t RESTART_SETTLE_MS = 380;
+
+    // DIM8
+    constexpr uint8_t DIM8_CHANNELS[] = {0x12, 0x1C, 0x00, 0x00, 0x01, 0x01, 0x01, 0x02, 0x01, 0x03, 0x01,
+                                         0x04, 0x01, 0x05, 0x01, 0x06, 0x01, 0x07, 0x01};
+    constexpr uint8_t DIM8_LOAD_0[] = {0x05, 0x14, 0x00, 0x00, 0xFF, 0xFF};
+    constexpr uint8_t DIM8_LOAD_1[] = {0x05, 0x14, 0x00, 0x01, 0xFF, 0xFF};
+    constexpr uint8_t DIM8_LOAD_2[] = {0x05, 0x14, 0x00, 0x02, 0xFF, 0xFF};
+    constexpr uint8_t DIM8_LOAD_3[] = {0x05, 0x14, 0x00, 0x03, 0xFF, 0xFF};
+    constexpr uint8_t DIM8_LOAD_4[] = {0x05, 0x14, 0x00, 0x04, 0xFF, 0xFF};
+    constexpr uint8_t DIM8_LOAD_5[] = {0x05, 0x14, 0x00, 0x05, 0xFF, 0xFF};
+    constexpr uint8_t DIM8_LOAD_6[] = {0x05, 0x14, 0x00, 0x06, 0xFF, 0xFF};
+    constexpr uint8_t DIM8_LOAD_7[] = {0x05, 0x14, 0x00, 0x07, 0xFF, 0xFF};
+
+    constexpr Step DIM8_STEPS[] = {
+        {CONFIG_START, sizeof(CONFIG_START), RESTART_SETTLE_MS},
+        {TIME_SYNC, sizeof(TIME_SYNC), STEP_MS},
+        {DIM8_CHANNELS, sizeof(DIM8_CHANNELS), STEP_MS},
+        {DIM8_LOAD_0, sizeof(DIM8_LOAD_0), POLL_GAP_MS},
+        {DIM8_LOAD_1, sizeof(DIM8_LOAD_1), STEP_MS},
+        {DIM8_LOAD_2, sizeof(DIM8_LOAD_2), STEP_MS},
+        {DIM8_LOAD_3, sizeof(DIM8_LOAD_3), STEP_MS},
+        {DIM8_LOAD_4, sizeof(DIM8_LOAD_4), STEP_MS},
+        {DIM8_LOAD_5, sizeof(DIM8_LOAD_5), STEP_MS},
+        {DIM8_LOAD_6, sizeof(DIM8_LOAD_6), POLL_GAP_MS},
+        {DIM8_LOAD_7, sizeof(DIM8_LOAD_7), STEP_MS},
+        {CONFIG_END, sizeof(CONFIG_END), STEP_MS},
+    };
+
+    // DIMU8: channel tables go through the 0x20 sub-address wrapper
+    constexpr uint8_t DIMU8_CHANNELS_A[] = {
+        0x35, 0x20, 0x03, 0x32, 0x1C, 0x04, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x01, 0x00, 0x00,
+        0xFF, 0xFF, 0x00, 0x02, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x03, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x04,
+        0x00, 0x00, 0xFF, 0xFF, 0x00, 0x05, 0x00, 0x00, 0xFF, 0x0F, 0x00, 0x06, 0x00, 0x00, 0xFF, 0xFF,
+        0x00, 0x07, 0x00, 0x00, 0xFF, 0xFF};
+    constexpr uint8_t DIMU8_CHANNELS_B[] = {
+        0x35, 0x20, 0x04, 0x32, 0x1C, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+        0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04,
+        0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01,
+        0x00, 0x07, 0x00, 0x00, 0x00, 0x01};
+    constexpr uint8_t DIMU8_CHANNELS_C[] = {
+        0x41, 0x20, 0x05, 0x3E, 0x1C, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00,
+        0x00, 0x00};
+    constexpr uint8_t DIMU8_CHANNELS_D[] = {
+        0x29, 0x20, 0x05, 0x26, 0x1C, 0x04, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0E,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00};
+
+    constexpr Step DIMU8_STEPS[] = {
+        {CONFIG_START, sizeof(CONFIG_START), RESTART_SETTLE_MS},
+        {TIME_SYNC, sizeof(TIME_SYNC), POLL_GAP_MS},
+        {DIMU8_CHANNELS_A, sizeof(DIMU8_CHANNELS_A), POLL_GAP_MS},
+        {DIMU8_CHANNELS_B, sizeof(DIMU8_CHANNELS_B), POLL_GAP_MS},
+        {DIMU8_CHANNELS_C, sizeof(DIMU8_CHANNELS_C), POLL_GAP_MS},
+        {DIMU8_CHANNELS_D, sizeof(DIMU8_CHANNELS_D), POLL_GAP_MS},
+        {CONFIG_END, sizeof(CONFIG_END), STEP_MS},
+    };
+
+    // IO_48: answered with a time sync only
+    constexpr Step IO48_STEPS[] = {
+        {TIME_SYNC, sizeof(TIME_SYNC), STEP_MS},
+    };
+
+    constexpr Sequence DIM8 = {DIM8_STEPS, sizeof(DIM8_STEPS) / sizeof(DIM8_STEPS[0])};
+    constexpr Sequence DIMU8 = {DIMU8_STEPS, sizeof(DIMU8_STEPS) / sizeof(DIMU8_STEPS[0])};
+    constexpr Sequence IO48 = {IO48_STEPS, sizeof(IO48_STEPS) / sizeof(IO48_STEPS[0])};
+
+    // Each frame's length byte must match the bytes that follow it
+    constexpr bool lengthsConsistent(const Sequence& sequence) {
+        for (size_t i = 0; i < sequence.count; i++) {
+            if (sequence.steps[i].frame[0] + 1 != sequence.steps[i].length) return false;
+        }
+        return true;
+    }
+    static_assert(lengthsConsistent(DIM8), "DIM8 sequence has a bad length byte");
+    static_assert(lengthsConsistent(DIMU8), "DIMU8 sequence has a bad length byte");
+    static_assert(lengthsConsistent(IO48), "IO48 sequence has a bad length byte");
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Incremental decoder for Crestron bus frames
+ *
+ * Wire format (as decoded by checkResp() in example.ino):
+ *   master -> slave:  [address] [0x00]                  ping
+ *                     [address] [length] [payload...]   command
+ *   slave -> master:  [0x02]    [0x00]                  ping reply
+ *                     [0x02]    [length] [payload...]   data / request
+ *
+ * Bytes may be fed in arbitrary spans; a frame split across reads or several
+ * frames merged into one read decode the same. All state lives in the object
+ * (one 255-byte payload buffer, the largest length the format can express),
+ * so nothing is allocated and no input can overrun it. The parser has no
+ * platform dependencies and can be built for the host.
+ */
+class CrestronFrameParser {
+public:
+    enum class Direction : uint8_t {
+        MASTER_TO_SLAVE,
+        SLAVE_TO_MASTER
+    };
+
+    static constexpr size_t MAX_PAYLOAD_LENGTH = 255;
+
+    struct Frame {
+        Direction direction;
+        uint8_t address;        // Destination for m>s, polled slave for s>m
+        bool isPing;            // [x] [0x00]: ping or ping reply, no payload
+        uint8_t length;
+        uint8_t payload[MAX_PAYLOAD_LENGTH];
+    };
+
+    CrestronFrameParser();
+
+    /**
+     * Consume bytes until one frame completes or the span is exhausted.
+     * Returns the number of bytes consumed; when hasFrame() is true afterwards
+     * the frame is valid until the next call. Callers loop until the whole
+     * span has been consumed.
+     */
+    size_t feed(const uint8_t* data, size_t length);
+
+    bool hasFrame() const { return m_frameReady; }
+    const Frame& frame() const { return m_frame; }
+
+    /**
+     * Slave replies carry no address of their own; they belong to the slave
+     * the master last addressed. The master's own transmissions are not
+     * echoed back, so it tells the parser who it just polled.
+     */
+    void setPolledAddress(uint8_t address) { m_polledAddress = address; }
+
+    // Drop any partially received frame, e.g. after a line break or overflow
+    void reset();
+
+    // Statistics
+    uint32_t getFrameCount() const { return m_frameCount; }
+    uint32_t getSkippedByteCount() const { return m_skippedByteCount; }
+
+private:
+    enum class State : uint8_t {
+        IDLE,           // Waiting for a prefix / address byte
+        LENGTH,         // Prefix seen, next byte is 0x00 (ping) or length
+        PAYLOAD         // Collecting m_frame.length payload bytes
+    };
+
+    State m_state;
+    bool m_frameReady;
+    uint8_t m_polledAddress;
+    uint8_t m_received;
+    Frame m_frame;
+
+    uint32_t m_frameCount;
+    uint32_t m_skippedByteCount;
+
+    void completeFrame();
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <driver/uart.h>
+#include <freertos/queue.h>
+#include <RS485Port.h>
+#include "BusTransport.h"
+
+/**
+ * BusTransport on an ESP32 UART in RS485 half-duplex mode
+ * Thin adapter over the shared RS485Port driver; UART events are translated
+ * one-to-one into transport events.
+ */
+class Esp32UartTransport : public BusTransport {
+public:
+    Esp32UartTransport();
+    ~Esp32UartTransport() override;
+
+    bool open(const BusSettings& settings) override;
+    void close() override;
+
+    bool waitEvent(Event& event, TickType_t timeout) override;
+    int read(uint8_t* buffer, size_t length) override;
+    void flushInput() override;
+    void discardInput() override;
+
+    int write(const uint8_t* data, size_t length) override;
+    int writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) override;
+    bool waitTxDone(TickType_t timeout) override;
+    bool collisionDetected() override;
+
+    uint32_t characterTimeUs() const override { return m_port.characterTimeUs(); }
+
+private:
+    static constexpr size_t RX_BUFFER_SIZE = 1024;
+    static constexpr size_t TX_BUFFER_SIZE = 512;
+
+    RS485Port m_port;
+    QueueHandle_t m_eventQueue;
+};
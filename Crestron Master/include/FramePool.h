@@ -0,0 +1,36 @@
+#pragma once
+
+#include "SpscRing.h"
+
+/**
+ * Fixed pool of frame buffers handed around by pointer
+ * The free list is an SpscRing, so each pool must have a single acquiring task
+ * and a single releasing task (e.g. TX: SlaveManager acquires, TX task releases).
+ */
+template <typename T, size_t Count>
+class FramePool {
+public:
+    FramePool() {
+        for (size_t i = 0; i < Count; i++) {
+            m_free.push(&m_items[i]);
+        }
+    }
+
+    T* acquire() {
+        T* item = nullptr;
+        return m_free.pop(item) ? item : nullptr;
+    }
+
+    void release(T* item) {
+        if (item) {
+            m_free.push(item);
+        }
+    }
+
+    size_t available() const { return m_free.size(); }
+    static constexpr size_t size() { return Count; }
+
+private:
+    T m_items[Count];
+    SpscRing<T*, Count> m_free;
+};
@@ -0,0 +1,37 @@
+// HeapTracker.h - per-task count of heap allocations after start-up
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+
+/**
+ * Counts malloc/calloc/realloc calls per task once arm() has been called
+ *
+ * Built in when CRESTRON_HEAP_TRACKING is defined (the debug environment),
+ * which also links with --wrap for the three functions so every caller,
+ * operator new included, goes through the counters. In other builds the
+ * functions are empty and isEnabled() is false.
+ *
+ * Everything the master needs is allocated before arm(); any count that
+ * grows afterwards is a steady-state allocation to hunt down.
+ */
+namespace HeapTracker {
+    constexpr size_t MAX_TASKS = 16;
+
+    struct TaskCount {
+        TaskHandle_t task;
+        char name[configMAX_TASK_NAME_LEN];
+        uint32_t allocations;
+        uint32_t bytes;
+    };
+
+    bool isEnabled();
+    void arm();
+    void reset();
+
+    // Copies the per-task counts; returns how many tasks have allocated
+    size_t snapshot(TaskCount* counts, size_t maxCount);
+    uint32_t getTotalCount();
+    uint32_t getUntrackedCount();   // From interrupts, or with the task table full
+}
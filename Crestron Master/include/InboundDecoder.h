@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CrestronFrameParser.h"
+
+/**
+ * Decodes slave-to-master frames into typed events
+ *
+ * A slave answers a poll with [0x02] [0x00] when it has nothing to report,
+ * otherwise with one data frame in its place. The payload's first byte
+ * selects a row of the decoder table; a frame no row accepts becomes an
+ * UNKNOWN event carrying the raw payload, so nothing is dropped silently.
+ *
+ * Payload layouts:
+ *   config request:   [0x03] [0x00]
+ *   input change:     [0x00] [join lo] [join hi | 0x80 if released]
+ *                     (digital join, as Crestron Slave's switch reports it)
+ *   dimmer feedback:  [0x01] [channel] [level hi] [level lo]
+ *                     (analog join; not yet checked against a real dimmer)
+ *
+ * Like CrestronFrameParser it has no platform dependencies.
+ */
+class InboundDecoder {
+public:
+    enum class EventType : uint8_t {
+        PING_ACK,
+        CONFIG_REQUEST,
+        INPUT_CHANGE,
+        DIMMER_FEEDBACK,
+        UNKNOWN,
+        COUNT
+    };
+
+    static constexpr uint8_t DIGITAL_JOIN = 0x00;
+    static constexpr uint8_t ANALOG_JOIN = 0x01;
+    static constexpr uint8_t CONFIG_REQUEST = 0x03;
+    static constexpr uint8_t JOIN_RELEASED = 0x80;  // In the digital join's high byte
+
+    struct Event {
+        EventType type;
+        uint8_t address;            // Slave that was polled
+        int64_t timestampUs;        // esp_timer time the frame was delimited on the bus
+        uint16_t index;             // Input join (0-based) or dimmer channel (1-based)
+        uint16_t value;             // 1 pressed / 0 released, or the reported level
+        uint8_t length;
+        const uint8_t* payload;     // Raw payload; valid only while the event is handled
+    };
+
+    // Fills event from a slave-to-master frame; false for master-to-slave frames
+    static bool decode(const CrestronFrameParser::Frame& frame, int64_t timestampUs, Event& event);
+
+    static const char* typeName(EventType type);
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Fixed-bucket latency histogram in microseconds
+ * Buckets are log-linear: exact below 4 us, then four buckets per power of
+ * two, so any reported percentile is within 25% of the true value. Samples
+ * above ~16 s land in the last bucket. record() is a relaxed atomic add and
+ * never blocks, so it is safe from any task or the esp_timer callback while
+ * another task reads percentiles.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_EXPONENT = 24;
+    static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    struct Summary {
+        uint32_t count;
+        uint32_t p50;
+        uint32_t p95;
+        uint32_t p99;
+        uint32_t max;
+    };
+
+    LatencyHistogram() { reset(); }
+
+    void record(int64_t valueUs) {
+        uint32_t value = valueUs > 0 ? static_cast<uint32_t>(valueUs) : 0;
+        m_counts[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max &&
+               !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Percentiles report the upper edge of the bucket, capped at the true max
+    Summary summarize() const {
+        uint32_t counts[BUCKET_COUNT];
+        uint32_t total = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] = m_counts[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        Summary summary = {total, 0, 0, 0, m_max.load(std::memory_order_relaxed)};
+        if (total == 0) return summary;
+
+        const uint32_t rank50 = (total * 50 + 99) / 100;
+        const uint32_t rank95 = (total * 95 + 99) / 100;
+        const uint32_t rank99 = (total * 99 + 99) / 100;
+        uint32_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            if (counts[i] == 0) continue;
+            uint32_t before = seen;
+            seen += counts[i];
+            uint32_t edge = upperEdge(i) < summary.max ? upperEdge(i) : summary.max;
+            if (before < rank50 && seen >= rank50) summary.p50 = edge;
+            if (before < rank95 && seen >= rank95) summary.p95 = edge;
+            if (before < rank99 && seen >= rank99) summary.p99 = edge;
+        }
+        return summary;
+    }
+
+    // Not atomic with respect to concurrent record(); a sample may survive
+    void reset() {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            m_counts[i].store(0, std::memory_order_relaxed);
+        }
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> m_counts[BUCKET_COUNT];
+    std::atomic<uint32_t> m_max;
+
+    static size_t bucketFor(uint32_t value) {
+        if (value < SUB_BUCKETS) return value;
+
+        uint32_t exponent = 31 - __builtin_clz(value);
+        if (exponent > MAX_EXPONENT) return BUCKET_COUNT - 1;
+
+        uint32_t shift = exponent - SUB_BUCKET_BITS;
+        uint32_t sub = (value >> shift) & (SUB_BUCKETS - 1);
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    static uint32_t upperEdge(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return static_cast<uint32_t>(bucket);
+
+        uint32_t shift = static_cast<uint32_t>(bucket / SUB_BUCKETS) - 1;
+        uint32_t sub = static_cast<uint32_t>(bucket % SUB_BUCKETS);
+        uint32_t lower = static_cast<uint32_t>(SUB_BUCKETS + sub) << shift;
+        return lower + ((1u << shift) - 1);
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "BusTransport.h"
+
+/**
+ * BusTransport for the native (Linux) build
+ *
+ * Without a device path it creates a pseudo-terminal; whatever opens the
+ * slave side (SlaveSimulator, socat, a bus bridge) is on the other end of the
+ * "bus". With a device path it drives a serial adapter, e.g. a USB-RS485
+ * dongle, at the bus baud rate.
+ *
+ * A reader thread reproduces the UART's RX-timeout: bytes are reported as one
+ * DATA event with frameEnd once the line has been quiet for the bus's idle
+ * timeout. Transmission timing is modelled from the baud rate so waitTxDone()
+ * returns when the last stop bit would have left a real UART.
+ */
+class PtyTransport : public BusTransport {
+public:
+    explicit PtyTransport(const char* devicePath = nullptr);
+    ~PtyTransport() override;
+
+    bool open(const BusSettings& settings) override;
+    void close() override;
+
+    // Path the other end opens (the pty slave), or the device path
+    const char* peerPath() const { return m_peerPath; }
+
+    bool waitEvent(Event& event, TickType_t timeout) override;
+    int read(uint8_t* buffer, size_t length) override;
+    void flushInput() override;
+    void discardInput() override;
+
+    int write(const uint8_t* data, size_t length) override;
+    int writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) override;
+    bool waitTxDone(TickType_t timeout) override;
+    bool collisionDetected() override { return false; }
+
+    uint32_t characterTimeUs() const override { return m_characterTimeUs; }
+
+private:
+    static constexpr size_t RX_BUFFER_SIZE = 1024;
+    static constexpr size_t RX_FULL_THRESHOLD = 120;    // As the UART's RX FIFO full interrupt
+
+    const char* m_devicePath;
+    char m_peerPath[64];
+    int m_fd;
+    int m_peerFd;           // Held open so the pty master never sees a hang-up
+    uint32_t m_baudRate;
+    uint32_t m_characterTimeUs;
+    uint32_t m_idleTimeoutUs;
+
+    std::thread m_reader;
+    std::atomic<bool> m_running;
+
+    std::mutex m_rxMutex;
+    std::condition_variable m_rxCv;
+    std::deque<uint8_t> m_rxBytes;
+    std::deque<Event> m_events;
+
+    std::mutex m_txMutex;
+    int64_t m_txDoneUs;
+
+    bool configureLine(int fd);
+    void readerLoop();
+    void pushEvent(const Event& event);
+};
@@ -1,80 +1,243 @@
 #pragma once
 
 #include <Arduino.h>
-#include <driver/uart.h>
-#include <freertos/queue.h>
-#include <freertos/semphr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+#include <atomic>
 #include "config.h"
+#include "BusCapture.h"
+#include "BusTransport.h"
+#include "FramePool.h"
+#include "LatencyHistogram.h"
+#include "Seqlock.h"
+#include "SpscRing.h"
 
 /**
  * High-precision RS485 communication class
- * Uses hardware UART for precise timing and FreeRTOS queues for thread-safe communication
+ * Uses hardware UART for precise timing and lock-free rings for passing frames between tasks
+ *
+ * Bytes move through a BusTransport. On the target that is the UART in RS485
+ * half-duplex mode (Esp32UartTransport over RS485Port): DE/RE follows the
+ * peripheral's RTS output, so bus turnaround needs no task-level delays.
+ *
+ * Reception is driven by transport events: bytes are accumulated until the
+ * line has been idle for the RX timeout, so each Message holds exactly one
+ * on-wire frame.
+ *
+ * Frames live in fixed pools and only pointers travel through the TX/RX
+ * rings. The rings are single-producer/single-consumer: transmit methods must
+ * be called from one task (the SlaveManager task) and receive methods from one
+ * task (the same, or another single consumer).
+ *
+ * Outgoing frames are queued on one of three lanes. The TX task always takes
+ * polls first, then control frames; bulk frames (configuration sequences) go
+ * out only if they finish on the wire before the next poll deadline. While a
+ * transaction waits for its reply nothing else is transmitted. The UART holds
+ * one frame at a time, so the lanes are the only queue.
+ *
+ * transact() combines both sides: it sends a request and waits for the reply
+ * with a microsecond deadline measured from the moment the last stop bit left
+ * the UART, so it must be called from a task that is both producer and consumer.
  */
 class RS485Communication {
 public:
     struct Message {
         uint8_t data[CrestronProtocol::MAX_MESSAGE_LENGTH];
         size_t length;
-        uint32_t timestamp;
+        int64_t timestampUs;   // esp_timer time the frame was submitted (TX) or delimited (RX)
+        uint8_t breakBits;     // TX only: line break appended by the UART, in bit times
+        bool awaitTxDone;      // TX only: report end-of-transmit to a pending transaction
         bool isIncoming;
+        uint16_t txTag;        // TX only: nonzero frames are timed as a group (getTaggedTxStats)
+    };
+    
+    // Wire timing of the frames carrying the most recent tag; a new tag
+    // starts over
+    struct TaggedTxStats {
+        uint16_t tag;
+        uint16_t frames;
+        int64_t firstStartUs;   // First frame handed to the UART
+        int64_t lastDoneUs;     // Last frame's final stop bit
+    };
+
+    enum class TxLane : uint8_t {
+        POLL,       // Pings and other transactions; always first
+        CONTROL,    // Short commands (DIM, break)
+        BULK,       // Configuration sequences; must fit before the next poll
+        COUNT
     };
 
-    RS485Communication();
+    enum class TransactionStatus {
+        REPLY,
+        TIMEOUT,
+        COLLISION,
+        SEND_FAILED
+    };
+
+    struct TransactionResult {
+        TransactionStatus status;
+        Message* reply;          // Set for REPLY only; release with releaseMessage()
+        int64_t txDoneUs;        // esp_timer time the request finished transmitting
+        uint32_t turnaroundUs;   // txDone to (estimated) first reply byte
+    };
+
+    RS485Communication(BusTransport& transport, const BusSettings& settings = RS485Config::BUSES[0]);
     ~RS485Communication();
 
     bool initialize();
     void deinitialize();
     
-    // Transmission methods
-    bool sendMessage(const uint8_t* data, size_t length);
+    // Transmission methods (single producer task)
+    Message* acquireTxMessage();             // Fill data/length in place, then submit
+    bool submitTxMessage(Message* message, TxLane lane = TxLane::CONTROL);
+    bool sendMessage(const uint8_t* data, size_t length, TxLane lane = TxLane::CONTROL);
     bool sendPing(uint8_t slaveAddress);
-    bool sendBreak(); // Send zero-bit break signal
+    bool sendBreak(uint32_t durationUs = CrestronTiming::BREAK_DURATION_US); // Queued UART line break
+    
+    // Request/response: replyTimeoutUs runs from end-of-transmit until the reply is delimited
+    TransactionResult transact(Message* request, uint32_t replyTimeoutUs);
+    
+    // esp_timer time the next poll is due; bulk frames that would overrun it
+    // are held back. 0 means no poll is scheduled.
+    void setNextPollDeadline(int64_t deadlineUs) { m_nextPollDeadlineUs.store(deadlineUs, std::memory_order_relaxed); }
     
-    // Reception methods
-    bool receiveMessage(Message& message, TickType_t timeout = portMAX_DELAY);
+    // Reception methods (single consumer task); every returned message must be released
+    Message* receiveMessage(TickType_t timeout = portMAX_DELAY);
+    void releaseMessage(Message* message);
     size_t getAvailableMessages() const;
     
     // Status and diagnostics
     bool isInitialized() const { return m_initialized; }
+    const BusSettings& getSettings() const { return m_settings; }
     uint32_t getTransmitCount() const { return m_transmitCount; }
     uint32_t getReceiveCount() const { return m_receiveCount; }
     uint32_t getErrorCount() const { return m_errorCount; }
+    uint32_t getFifoOverflowCount() const { return m_fifoOverflowCount; }
+    uint32_t getFrameErrorCount() const { return m_frameErrorCount; }
+    uint32_t getBufferFullCount() const { return m_bufferFullCount; }
+    uint32_t getCollisionCount() const { return m_collisionCount; }
+    uint32_t getTransactionTimeoutCount() const { return m_transactionTimeoutCount; }
+    uint32_t getUnsolicitedCount() const { return m_unsolicitedCount; }
+    
+    // Latency histograms (microseconds)
+    const LatencyHistogram& getTurnaroundHistogram() const { return m_turnaroundAll; }
+    const LatencyHistogram& getInterArrivalHistogram() const { return m_interArrival; }
+    const LatencyHistogram& getTxQueueWaitHistogram(TxLane lane) const { return m_lanes[laneIndex(lane)].queueWait; }
+    const LatencyHistogram& getEnqueueToWireHistogram() const { return m_enqueueToWire; }
+    
+    // Per-slave turnaround; slots are claimed by address in order of first
+    // reply. Replies from addresses left without a slot are only counted.
+    size_t getTurnaroundSlotCount() const { return m_turnaroundSlotsUsed; }
+    const LatencyHistogram* getTurnaroundHistogram(size_t slot, uint8_t& address) const;
+    uint32_t getTurnaroundDroppedCount() const { return m_turnaroundDropped; }
+    size_t getTurnaroundDroppedAddresses() const;
+    void resetHistograms();
+    
+    // Per-lane queue depth (now and high-water mark) and bulk frames held for a poll
+    size_t getLaneDepth(TxLane lane) const { return m_lanes[laneIndex(lane)].ring.size(); }
+    uint32_t getLaneMaxDepth(TxLane lane) const { return m_lanes[laneIndex(lane)].maxDepth; }
+    uint32_t getBulkDeferCount() const { return m_bulkDeferCount; }
+    TaggedTxStats getTaggedTxStats() const;
+    
+    // Frame capture; the buffer is allocated the first time capture is enabled
+    bool enableCapture(bool enable);
+    BusCapture& getCapture() { return m_capture; }
     
     // Low-level control
-    void setTransmitMode(bool enable);
     void flushBuffers();
 
 private:
-    static constexpr uart_port_t UART_PORT = UART_NUM_2;
-    static constexpr size_t RX_BUFFER_SIZE = 1024;
-    static constexpr size_t TX_BUFFER_SIZE = 512;
+    static constexpr uint32_t TX_DONE_TIMEOUT_MS = 50;  // Longer than a full-length frame
+    static constexpr size_t TURNAROUND_SLOTS = RS485Config::TURNAROUND_HISTOGRAMS;
+    static constexpr size_t LANE_COUNT = static_cast<size_t>(TxLane::COUNT);
+    
+    using MessagePool = FramePool<Message, CrestronProtocol::FRAME_POOL_SIZE>;
+    using MessageRing = SpscRing<Message*, CrestronProtocol::FRAME_POOL_SIZE>;
     
+    const BusSettings m_settings;
     bool m_initialized;
-    QueueHandle_t m_rxQueue;
-    QueueHandle_t m_txQueue;
-    SemaphoreHandle_t m_txMutex;
+    BusTransport& m_transport;
     TaskHandle_t m_rxTaskHandle;
     TaskHandle_t m_txTaskHandle;
+    TaskHandle_t volatile m_rxWaiter;
+    
+    // Task storage, so the bus tasks are not allocated from the heap
+    StaticTask_t m_rxTaskBuffer;
+    StaticTask_t m_txTaskBuffer;
+    StackType_t m_rxTaskStack[StackSizes::RS485_HANDLER];
+    StackType_t m_txTaskStack[StackSizes::RS485_HANDLER];
+    
+    Seqlock<TaggedTxStats> m_taggedTx;     // Written by the TX task only
+    
+    // Pending transaction (at most one; owned by the calling task)
+    esp_timer_handle_t m_deadlineTimer;
+    TaskHandle_t volatile m_txnOwner;
+    std::atomic<bool> m_txnTxDone;
+    bool m_txnCollision;
+    int64_t m_txnTxDoneUs;
+    
+    // Frame storage: TX frames are acquired by the producer and released by
+    // the TX task, RX frames the other way round
+    MessagePool m_txPool;
+    MessagePool m_rxPool;
+    MessageRing m_rxRing;
+    BusCapture m_capture;
+    
+    // TX lanes; each ring can hold the whole pool, so a push never fails
+    struct TxLaneState {
+        MessageRing ring;
+        LatencyHistogram queueWait;
+        volatile uint32_t maxDepth;
+    };
+    
+    TxLaneState m_lanes[LANE_COUNT];
+    std::atomic<int64_t> m_nextPollDeadlineUs;   // 64-bit: read whole, never torn
+    volatile uint32_t m_bulkDeferCount;
+    Message* m_deferredBulk;          // TX task only; counts each held frame once
     
     // Statistics
     volatile uint32_t m_transmitCount;
     volatile uint32_t m_receiveCount;
     volatile uint32_t m_errorCount;
+    volatile uint32_t m_fifoOverflowCount;
+    volatile uint32_t m_frameErrorCount;
+    volatile uint32_t m_bufferFullCount;
+    volatile uint32_t m_collisionCount;
+    volatile uint32_t m_transactionTimeoutCount;
+    volatile uint32_t m_unsolicitedCount;
+    
+    // Latency histograms: turnaround is recorded by the transaction caller,
+    // inter-arrival by the RX task, queue wait and enqueue-to-wire by the TX task
+    struct TurnaroundSlot {
+        uint8_t address;
+        LatencyHistogram histogram;
+    };
+    
+    LatencyHistogram m_turnaroundAll;
+    LatencyHistogram m_interArrival;
+    LatencyHistogram m_enqueueToWire;
+    TurnaroundSlot m_turnaroundSlots[TURNAROUND_SLOTS];
+    std::atomic<size_t> m_turnaroundSlotsUsed;
+    std::atomic<uint32_t> m_turnaroundDropped;
+    std::atomic<uint32_t> m_turnaroundDroppedMask[256 / 32];   // Addresses without a slot
     
     // Internal methods
-    bool configureUART();
     void startTasks();
     void stopTasks();
     
     // Static task functions
     static void rxTaskFunction(void* parameter);
     static void txTaskFunction(void* parameter);
+    static void deadlineTimerCallback(void* parameter);
     
     // Instance task methods
     void handleReceive();
     void handleTransmit();
-    
-    // Timing utilities
-    void preciseDelay(uint32_t microseconds);
-    void criticalSectionDelay(uint32_t microseconds);
-};
\ No newline at end of file
+    void discardReceivedData();
+    void recordTurnaround(uint8_t address, uint32_t turnaroundUs);
+    Message* nextTxMessage(TickType_t& waitTicks);
+    static size_t laneIndex(TxLane lane) { return static_cast<size_t>(lane); }
+    bool waitForTxDone();
+    void releaseBus();
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "BusTransport.h"
+
+/**
+ * BusTransport that answers from a BusCapture dump, for the native --replay
+ *
+ * load() splits the capture into exchanges: a ping the master sent and the
+ * frames received before its next transmission. When the master under test
+ * pings an address, that address's next exchange is played back, each frame
+ * delimited after the delay it had behind the ping in the capture. The
+ * recorded slaves therefore answer as they did, however the master's
+ * schedule has moved. Frames received after level or configuration frames
+ * are not replayed, and an address with no exchanges left stays silent;
+ * isExhausted() tells when the master has pinged one.
+ *
+ * Frames are delivered by an esp_timer and transmission takes the frame's
+ * wire time, so on NativeClock's simulated time a replay is the same on every
+ * run. Everything the master transmits and every frame played back is
+ * logged with its time.
+ */
+class ReplayTransport : public BusTransport {
+public:
+    struct LogEntry {
+        int64_t timestampUs;
+        bool received;
+        bool lineBreak;             // Transmitted with a break after it
+        std::vector<uint8_t> data;
+    };
+
+    ReplayTransport();
+    ~ReplayTransport() override;
+
+    // Reads a capture; false, with the reason on stderr, if it is malformed
+    bool load(const char* path);
+    uint32_t getBaudRate() const { return m_baudRate; }
+    uint32_t getRecordCount() const { return m_recordCount; }
+    uint32_t getSpanUs() const { return m_spanUs; }             // First record to last
+    size_t getExchangeCount() const { return m_exchangeCount; }
+    size_t getUnattributedCount() const { return m_unattributed; }
+    size_t getRemainingExchanges() const;
+    bool isExhausted() const;                                   // A recorded slave went silent
+    std::vector<LogEntry> getLog() const;
+
+    bool open(const BusSettings& settings) override;
+    void close() override;
+
+    bool waitEvent(Event& event, TickType_t timeout) override;
+    int read(uint8_t* buffer, size_t length) override;
+    void flushInput() override;
+    void discardInput() override;
+
+    int write(const uint8_t* data, size_t length) override;
+    int writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) override;
+    bool waitTxDone(TickType_t timeout) override;
+    bool collisionDetected() override { return false; }
+
+    uint32_t characterTimeUs() const override { return m_characterTimeUs; }
+
+private:
+    static constexpr UBaseType_t EVENT_QUEUE_LENGTH = 16;
+
+    struct Reply {
+        uint32_t delayUs;           // From the ping being written
+        std::vector<uint8_t> data;
+    };
+    typedef std::vector<Reply> Exchange;
+
+    uint32_t m_baudRate;
+    uint32_t m_recordCount;
+    uint32_t m_spanUs;
+    size_t m_exchangeCount;
+    size_t m_unattributed;
+    uint32_t m_characterTimeUs;
+
+    mutable std::mutex m_mutex;
+    std::map<uint8_t, std::deque<Exchange>> m_exchanges;
+    size_t m_remaining;
+    bool m_exhausted;
+    std::multimap<int64_t, std::vector<uint8_t>> m_pending;    // By delivery time
+    std::deque<uint8_t> m_rxBytes;
+    std::vector<LogEntry> m_log;
+    int64_t m_txDoneUs;
+
+    QueueHandle_t m_events;
+    QueueHandle_t m_txDone;
+    esp_timer_handle_t m_rxTimer;
+    esp_timer_handle_t m_txDoneTimer;
+
+    static void rxTimerCallback(void* arg);
+    static void txDoneTimerCallback(void* arg);
+    void deliverDue();
+    void armRxTimer(int64_t now);
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "config.h"
+
+/**
+ * Named lighting scenes kept in NVS
+ *
+ * A scene is a list of (address, channel, level, ramp) targets that may span
+ * several dimmers and both buses; SlaveManager::recallScene() sends the ones
+ * that belong to its bus. All scenes are loaded into RAM by begin(), so a
+ * recall never waits on flash. save() and remove() write through to NVS.
+ * Safe to call from any task; a mutex guards the table.
+ */
+class SceneStore {
+public:
+    struct Target {
+        uint8_t address;
+        uint8_t channel;        // 1-based
+        uint8_t level;
+        uint16_t rampTime;      // Hundredths of a second, as in the DIM frame
+    };
+
+    struct Scene {
+        char name[SceneConfig::NAME_LENGTH];
+        uint8_t count;
+        Target targets[SceneConfig::MAX_TARGETS];
+    };
+
+    SceneStore();
+
+    // Creates the mutex and loads the stored scenes
+    bool begin();
+
+    // Adds the scene or replaces the one with the same name
+    bool save(const Scene& scene);
+    bool remove(const char* name);
+    bool get(const char* name, Scene& scene) const;
+
+    size_t count() const { return m_count; }
+    bool nameAt(size_t index, char* name, size_t length) const;
+
+private:
+    Scene m_scenes[SceneConfig::MAX_SCENES];
+    uint8_t m_slots[SceneConfig::MAX_SCENES];   // NVS key suffix of each scene
+    volatile size_t m_count;
+
+    SemaphoreHandle_t m_mutex;
+    StaticSemaphore_t m_mutexBuffer;
+
+    size_t findLocked(const char* name) const;
+    bool slotInUseLocked(uint8_t slot) const;
+    static void keyFor(uint8_t slot, char* key, size_t length);
+    static size_t blobSize(uint8_t count);
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/**
+ * Sequence lock around a value that one writer updates and any number of
+ * tasks read without blocking it
+ *
+ * The writer bumps the sequence to odd, updates the value in place and bumps
+ * it to even again; it never waits. A reader copies what it needs and retries
+ * if the sequence was odd or changed meanwhile, so it always sees one
+ * complete update. Writers must be serialized by the caller.
+ *
+ * Readers should copy plain data only and keep the read short. A reader that
+ * preempted the writer on the same core would spin until the writer runs
+ * again, so after a few failed attempts it sleeps for a tick.
+ */
+template <typename T>
+class Seqlock {
+public:
+    Seqlock() : m_sequence(0), m_value() {}
+
+    // Writer side: update(T&) changes the value in place
+    template <typename Update>
+    void write(Update update) {
+        const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        update(m_value);
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Reader side: read(const T&) copies out what it needs and may run more
+    // than once. Returns the version that was read.
+    template <typename Read>
+    uint32_t read(Read read) const {
+        for (uint32_t attempt = 1; ; attempt++) {
+            const uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                read(m_value);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before) {
+                    return before / 2;
+                }
+            }
+            if (attempt % SPIN_ATTEMPTS == 0) {
+                vTaskDelay(1);
+            }
+        }
+    }
+
+    // Number of completed updates
+    uint32_t version() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr uint32_t SPIN_ATTEMPTS = 8;
+
+    std::atomic<uint32_t> m_sequence;
+    T m_value;
+};
@@ -4,11 +4,21 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
-#include <freertos/timers.h>
-#include <map>
-#include <vector>
+#include <freertos/semphr.h>
+#include <atomic>
+#include <type_traits>
+#include <esp_timer.h>
 #include "config.h"
 #include "RS485Communication.h"
+#include "BusSchedule.h"
+#include "CommandCoalescer.h"
+#include "ConfigSequences.h"
+#include "CrestronFrameParser.h"
+#include "InboundDecoder.h"
+#include "LatencyHistogram.h"
+#include "SceneStore.h"
+#include "Seqlock.h"
+#include "SlaveTable.h"
 
 /**
  * Manages communication with multiple Crestron slave devices
@@ -19,7 +29,8 @@ public:
     enum class SlaveType {
         IO_48,      // 48-channel I/O module
         DIM8,       // 8-channel dimmer
-        DIMU8       // 8-channel universal dimmer
+        DIMU8,      // 8-channel universal dimmer
+        UNKNOWN     // Found by discovery; not configured until setSlaveType()
     };
     
     enum class SlaveState {
@@ -32,26 +43,61 @@ public:
         ERROR
     };
     
-    enum class ConfigStep {
-        NONE = 0,
-        INIT_SYNC,
-        TIME_SYNC,
-        CHANNEL_CONFIG,
-        LOAD_CONFIG,
-        FINALIZE,
-        COMPLETE
-    };
-
     struct SlaveInfo {
         uint8_t address;
         SlaveType type;
         SlaveState state;
-        ConfigStep configStep;
         uint32_t lastPingTime;
-        uint32_t configStepIndex;
+        uint32_t configStepIndex;   // Next step of the slave's ConfigSequences entry
+        uint32_t configNextTime;    // Tick count before which the next step waits
         bool dimRequest1;
         bool dimRequest2;
-        uint8_t errorCount;
+        bool configRequested;       // Sequence in progress; survives missed pings
+        uint32_t errorCount;        // Polls missed in total
+        uint32_t lastTurnaroundUs;
+        
+        // Link quality (see LinkQuality in config.h)
+        uint32_t latencyEwmaUs;     // Smoothed reply turnaround
+        uint16_t timeoutRatio;      // Smoothed share of polls missed, per LinkQuality::RATIO_SCALE
+        uint8_t failureStreak;      // Polls missed in a row, capped
+        bool onProbation;           // Polled at the probation cadence only
+        uint32_t lastSeenTime;      // Tick count of the last answer, 0 if never
+        uint32_t bytesSent;         // Polls, level and configuration frames
+        uint32_t bytesReceived;     // Answers to polls
+        uint32_t probationCount;    // Times put on probation
+        
+        // Poll scheduling
+        uint32_t nextPollTime;      // Tick count before which the slave is not polled
+        uint8_t backoffLevel;       // Consecutive missed pings, capped
+        uint8_t pendingCommands;    // Commands sent since the last poll
+        uint32_t pollCount;
+        uint32_t pollIntervalMs;    // Smoothed time between polls
+        
+        // Last level queued per channel, so scene recalls can skip channels
+        // already there; forgotten when the slave asks to be configured
+        uint8_t targetLevels[SlaveDevices::DIMMER_CHANNELS];
+        uint8_t knownLevels;        // Bit n-1 set once channel n has a level
+    };
+    
+    struct PollStats {
+        uint8_t address;
+        SlaveState state;
+        SlaveType type;
+        uint32_t configStepIndex;   // Next configuration step
+        uint8_t backoffLevel;
+        uint32_t pollCount;
+        uint32_t pollIntervalMs;
+        
+        // Link quality
+        uint32_t latencyEwmaUs;
+        uint16_t timeoutRatio;      // Per LinkQuality::RATIO_SCALE
+        uint8_t failureStreak;
+        bool onProbation;
+        uint32_t lastSeenTime;      // Tick count, 0 if never answered
+        uint32_t bytesSent;
+        uint32_t bytesReceived;
+        uint32_t errorCount;
+        uint32_t probationCount;
     };
 
     SlaveManager(RS485Communication& rs485);
@@ -63,89 +109,391 @@ public:
     // Slave management
     bool addSlave(uint8_t address, SlaveType type);
     bool removeSlave(uint8_t address);
+    // The slot schedule runs from initialize() on; while pinging is off the
+    // POLL slots stay idle
     void enablePinging(bool enable);
     
-    // Command interface
+    // Types a discovered slave; a configuration request it made meanwhile
+    // is served at its next poll
+    bool setSlaveType(uint8_t address, SlaveType type);
+    
+    // Background discovery probes the addresses not in the table one at a
+    // time: in poll cycles where no known slave is due, and otherwise in at
+    // most one of DiscoveryConfig::SLOT_SHARE cycles, so known slaves keep
+    // most of their poll rate. Addresses that answer are added.
+    void enableDiscovery(bool enable);
+    
+    struct DiscoveryStats {
+        bool enabled;
+        uint32_t probes;
+        uint32_t found;
+        uint32_t sweeps;            // Full passes over the address range
+        uint32_t lastSweepMs;       // Duration of the last full pass, 0 before the first
+        uint32_t estimatedSweepMs;  // Projected from the current pass's probe rate
+        uint8_t nextAddress;
+    };
+    DiscoveryStats getDiscoveryStats() const;
+    
+    // Command interface; levels for the same channel that have not gone out
+    // yet are merged, so only the newest is sent
     bool sendDimCommand(uint8_t address, uint8_t channel, uint8_t level, uint16_t rampTime = 0);
     bool sendDimUCommand(uint8_t address, uint8_t channel, uint8_t level, uint16_t rampTime = 0);
     
-    // Status queries
+    // Acknowledged levels. DIM frames have no reply of their own, so a level
+    // counts as delivered when the slave answers its next poll after the
+    // frame is on the wire. A missed poll (or a collision) sends it again,
+    // up to DeliveryConfig::MAX_ATTEMPTS times within timeoutMs. The
+    // callback runs once on the bus task with the outcome; it must return
+    // quickly and never block. Levels still in flight at deinitialize()
+    // are dropped without one.
+    enum class DeliveryOutcome : uint8_t {
+        DELIVERED,      // Confirmed on the first send
+        RETRIED,        // Confirmed after one or more resends
+        FAILED,         // Not confirmed within the deadline or attempts
+        SUPERSEDED,     // A newer level for the channel replaced it
+        COUNT
+    };
+    
+    struct DeliveryReport {
+        uint8_t address;
+        uint8_t channel;
+        uint8_t level;
+        DeliveryOutcome outcome;
+        uint8_t attempts;       // Frames that carried the level
+        uint32_t elapsedUs;     // From the call to the outcome
+    };
+    
+    typedef void (*DeliveryCallback)(const DeliveryReport& report, void* context);
+    
+    // DIM or DIMU by the slave's type. False (and no callback) if the slave
+    // is unknown, not a dimmer, or too many acked levels are in flight.
+    bool sendDimCommandAcked(uint8_t address, uint8_t channel, uint8_t level, uint16_t rampTime,
+                             uint32_t timeoutMs, DeliveryCallback callback, void* context = nullptr);
+    
+    struct DeliveryStats {
+        uint32_t outcomes[static_cast<size_t>(DeliveryOutcome::COUNT)];
+        uint32_t resends;       // Extra frames sent for acked levels
+        uint32_t inFlight;
+    };
+    DeliveryStats getDeliveryStats() const;
+    // From the call to a DELIVERED or RETRIED outcome
+    const LatencyHistogram& getDeliveryLatencyHistogram() const { return m_deliveryLatency; }
+    
+    // Several channels of one slave at once (e.g. a scene); pending levels
+    // for a slave share frames up to setMaxLevelsPerFrame() either way
+    struct ChannelLevel {
+        uint8_t channel;
+        uint8_t level;
+        uint16_t rampTime;
+    };
+    bool sendDimLevels(uint8_t address, const ChannelLevel* levels, size_t count, bool universal = false);
+    
+    // Queues every target of the scene on this bus in one go (targets for
+    // unknown addresses are left to the other bus) and skips channels already
+    // at their level. Returns how many levels were queued; levels the table
+    // had no room for are counted in SceneRecallStats::truncated.
+    size_t recallScene(const SceneStore::Scene& scene);
+    
+    struct SceneRecallStats {
+        uint16_t levels;        // Channels queued
+        uint16_t skipped;       // Channels already at their target
+        uint16_t truncated;     // Channels dropped with the level table full
+        uint16_t frames;        // DIM/DIMU frames that carried them
+        uint32_t wireSpanUs;    // First frame on the wire to the last one done
+        uint32_t totalUs;       // recallScene() to the last frame done
+        bool complete;          // False if the frames did not all go out in time
+    };
+    
+    // Most recent finished recall; false if there has been none
+    bool getLastSceneRecall(SceneRecallStats& stats) const;
+    uint32_t getFinishedRecallCount() const { return m_lastRecall.version(); }
+    const LatencyHistogram& getSceneSpanHistogram() const { return m_sceneSpan; }
+    
+    // Slave-to-master events (see InboundDecoder). Callbacks run on the bus
+    // task as soon as the reply is decoded, so they must return quickly and
+    // never block; hand anything longer to another task. Subscriptions last
+    // for the life of the manager.
+    using InboundEvent = InboundDecoder::Event;
+    using InboundEventType = InboundDecoder::EventType;
+    typedef void (*InboundCallback)(const InboundEvent& event, void* context);
+    bool subscribe(InboundEventType type, InboundCallback callback, void* context = nullptr);
+    
+    uint32_t getInboundEventCount(InboundEventType type) const {
+        return m_eventCounts[static_cast<size_t>(type)];
+    }
+    // From the frame being delimited on the bus to its callbacks starting
+    const LatencyHistogram& getEventLatencyHistogram() const { return m_eventLatency; }
+    
+    // Channels packed into one DIM/DIMU frame, 1 to MAX_LEVELS_PER_FRAME.
+    // The default of 1 is the format known to work; raise it only for
+    // devices verified to accept multi-entry frames
+    void setMaxLevelsPerFrame(size_t count);
+    
+    // Status queries read the last published snapshot without locking, so
+    // UI and status tasks never hold up the bus task (or wait for it)
     SlaveState getSlaveState(uint8_t address) const;
-    std::vector<uint8_t> getOnlineSlaves() const;
-    std::vector<uint8_t> getOfflineSlaves() const;
+    size_t getOnlineSlaves(uint8_t* addresses, size_t maxCount) const;
+    size_t getPollStats(PollStats* stats, size_t maxCount) const;
+    bool getSlaveStats(uint8_t address, PollStats& stats) const;   // False if not in the table
+    uint32_t getSnapshotVersion() const { return m_snapshot.version(); }
     
     // Statistics
     uint32_t getTotalPings() const { return m_totalPings; }
     uint32_t getSuccessfulPings() const { return m_successfulPings; }
     uint32_t getConfigurationCount() const { return m_configurationCount; }
+    uint32_t getLateReplyCount() const { return m_lateReplyCount; }
+    uint32_t getUnmatchedReplyCount() const { return m_unmatchedReplyCount; }
+    const CommandCoalescer& getDimLevels() const { return m_dimLevels; }
+    uint32_t getLevelFrameCount() const { return m_levelFrameCount; }
+    uint32_t getProbationCount() const { return m_probationCount; }     // Slaves on probation now
+    
+    // Bus task, for its stack high-water mark; null before initialize()
+    TaskHandle_t getTaskHandle() const { return m_taskHandle; }
+    
+    // TDMA slot statistics (see BusSchedule.h)
+    struct SlotStats {
+        uint32_t cycleUs;       // One pass through the slot table at full slot lengths
+        uint32_t slots;         // Slot starts handled by the bus task
+        uint32_t skipped;       // Slot starts the timer could not hand over
+        uint32_t ended;         // Slots ended early, their work done
+        uint32_t overruns;      // Slots whose work ran past the slot's full length
+        uint32_t breaks;        // Breaks sent after a missed ping
+        uint32_t uses[static_cast<size_t>(BusSchedule::SlotUse::COUNT)];
+    };
+    SlotStats getSlotStats() const;
+    // Slot start as seen by the bus task, behind the start the timer was armed for
+    const LatencyHistogram& getSlotJitterHistogram() const { return m_slotJitter; }
+    // Actual time for one pass through the slot table
+    const LatencyHistogram& getCycleHistogram() const { return m_cycleTime; }
+    // How far an overrunning slot's work went past the slot's end
+    const LatencyHistogram& getSlotOverrunHistogram() const { return m_slotOverrun; }
 
 private:
+    static constexpr size_t MAX_QUEUED_LEVEL_FRAMES = 2;   // DIM frames allowed in the TX lane at once
+    static constexpr size_t MAX_QUEUED_CONFIG_FRAMES = 2;  // Configuration frames in the bulk lane at once
+    
     RS485Communication& m_rs485;
-    std::map<uint8_t, SlaveInfo> m_slaves;
+    SlaveTable<SlaveInfo> m_slaves;
+    CrestronFrameParser m_parser;
+    CommandCoalescer m_dimLevels;
+    size_t m_maxLevelsPerFrame;
     
     // FreeRTOS objects
     TaskHandle_t m_taskHandle;
-    TimerHandle_t m_pingTimer;
-    QueueHandle_t m_commandQueue;
+    esp_timer_handle_t m_slotTimer;
+    QueueHandle_t m_slotQueue;
     SemaphoreHandle_t m_slavesMutex;
     
+    // What the outstanding (or most recent) transaction expects back. Replies
+    // carry no address, so a slave frame is credited only if it arrives for
+    // this address before the deadline; later ones are counted as late.
+    enum class ReplyKind : uint8_t {
+        PING,       // 02 00, or the slave's pending data in place of it
+        DATA        // A data frame; a bare 02 00 does not answer it
+    };
+    
+    enum class ReplyMatch : uint8_t {
+        MATCHED,
+        LATE,
+        UNMATCHED
+    };
+    
+    struct Transaction {
+        bool active;            // A request has been sent and not superseded
+        uint8_t address;
+        ReplyKind expected;
+        int64_t sentUs;         // esp_timer time the request finished transmitting
+        int64_t deadlineUs;     // Replies delimited after this are late
+    };
+    
+    Transaction m_transaction;
+    
     // State management
     bool m_initialized;
-    bool m_pingEnabled;
-    uint8_t m_currentSlaveIndex;
+    volatile bool m_pingEnabled;
     uint32_t m_pingSequenceNumber;
     
     // Statistics
     volatile uint32_t m_totalPings;
     volatile uint32_t m_successfulPings;
     volatile uint32_t m_configurationCount;
+    volatile uint32_t m_lateReplyCount;
+    volatile uint32_t m_unmatchedReplyCount;
+    volatile uint32_t m_levelFrameCount;
+    volatile uint32_t m_probationCount;
     
-    // Configuration data
-    struct ConfigData {
-        SlaveType type;
-        std::vector<std::vector<uint8_t>> sequences;
+    size_t m_configCursor;      // Rotates which configuring slave goes first
+    size_t m_priorityCursor;    // Where the next scan for commanded slaves starts
+    bool m_lastPollPrioritised; // The previous poll went ahead of the rotation
+    
+    // Discovery; cursor and timing are used by the bus task only
+    volatile bool m_discoveryEnabled;
+    uint8_t m_discoveryCursor;
+    uint32_t m_cyclesSinceProbe;
+    TickType_t m_sweepStartTime;
+    uint32_t m_sweepProbes;
+    volatile uint32_t m_probeCount;
+    volatile uint32_t m_discoveredCount;
+    volatile uint32_t m_sweepCount;
+    volatile uint32_t m_lastSweepMs;
+    volatile uint32_t m_estimatedSweepMs;
+    
+    // Copy of the slave table for other tasks, republished after each change
+    struct StatusSnapshot {
+        uint16_t count;
+        uint8_t position[SlaveTable<SlaveInfo>::CAPACITY];  // Index in slaves + 1, 0 if not present
+        PollStats slaves[SlaveTable<SlaveInfo>::CAPACITY];  // Address order
     };
     
-    std::map<SlaveType, ConfigData> m_configTemplates;
+    Seqlock<StatusSnapshot> m_snapshot;
     
-    // Internal command structure
-    struct Command {
-        enum Type {
-            PING,
-            DIM_COMMAND,
-            DIMU_COMMAND,
-            CONFIG_STEP
-        } type;
-        
-        uint8_t address;
-        uint8_t channel;
-        uint8_t level;
-        uint16_t rampTime;
-        std::vector<uint8_t> data;
+    // Scene recall in progress. Its levels carry a tag that the frames built
+    // from them inherit, so RS485Communication can time them on the wire.
+    struct SceneRecall {
+        uint16_t tag;
+        uint16_t levelsPending;     // Tagged levels not yet in a frame
+        uint16_t frames;            // Tagged frames submitted
+        SceneRecallStats stats;
+        int64_t startUs;
+        TickType_t startTick;
     };
     
+    SceneRecall m_recall;       // Guarded by m_slavesMutex
+    volatile uint16_t m_recallTag;  // m_recall.tag while a recall is active, else 0
+    uint16_t m_nextRecallTag;
+    Seqlock<SceneRecallStats> m_lastRecall;     // Written by the bus task only
+    LatencyHistogram m_sceneSpan;
+    
+    // Inbound event subscribers; entries are complete before the count
+    // covers them, so the bus task reads the table without locking
+    static constexpr size_t MAX_SUBSCRIBERS = 8;
+    struct Subscriber {
+        InboundEventType type;
+        InboundCallback callback;
+        void* context;
+    };
+    Subscriber m_subscribers[MAX_SUBSCRIBERS];
+    std::atomic<size_t> m_subscriberCount;
+    volatile uint32_t m_eventCounts[static_cast<size_t>(InboundEventType::COUNT)];
+    LatencyHistogram m_eventLatency;
+    
+    // Acked levels in flight, guarded by m_slavesMutex. Frames in the control
+    // lane leave it in order, so a level whose frame was control frame n is
+    // on the wire once n - lane depth has passed it.
+    enum class DeliveryState : uint8_t {
+        FREE,
+        QUEUED,         // In m_dimLevels
+        SENT,           // In a frame; waiting for the slave's next poll
+        DONE            // Outcome set; reported by the bus task
+    };
+    
+    struct Delivery {
+        DeliveryState state;
+        DeliveryOutcome outcome;
+        uint8_t attempts;
+        CommandCoalescer::Entry entry;
+        uint32_t controlSeq;        // m_controlFrames once its last frame was submitted
+        int64_t startUs;
+        int64_t deadlineUs;
+        DeliveryCallback callback;
+        void* context;
+    };
+    
+    Delivery m_deliveries[DeliveryConfig::MAX_TRACKED];
+    // Finished deliveries, copied out so their callbacks run without the
+    // table lock. A member rather than a local, since the bus task's stack
+    // is small and the callbacks run on top of it; bus task only.
+    Delivery m_finishedDeliveries[DeliveryConfig::MAX_TRACKED];
+    uint32_t m_controlFrames;       // Frames submitted to the control lane; bus task only
+    uint32_t m_pollWireSeq;         // Control frames on the wire before the current poll
+    volatile uint32_t m_deliveryOutcomes[static_cast<size_t>(DeliveryOutcome::COUNT)];
+    volatile uint32_t m_resendCount;
+    LatencyHistogram m_deliveryLatency;
+    
+    // TDMA schedule. When a slot's work is done the bus task arms the slot
+    // timer for the next slot, to start once the frames it queued have left
+    // the wire; the timer callback hands that slot back through m_slotQueue.
+    // m_nextSlot is written by the bus task before it arms the timer and read
+    // by the callback, so only one of them touches it at a time.
+    struct SlotStart {
+        uint8_t index;          // Into BusSchedule::SLOTS
+        int64_t startUs;        // esp_timer time the slot was armed for
+    };
+    static_assert(std::is_trivially_copyable<SlotStart>::value, "SlotStart is copied through a FreeRTOS queue");
+    
+    uint32_t m_slotLengthUs[BusSchedule::SLOT_COUNT];   // Full lengths, the most a slot may take
+    uint32_t m_cycleUs;
+    uint32_t m_characterUs;
+    volatile bool m_slotsRunning;
+    SlotStart m_nextSlot;
+    int64_t m_nextPollSlotUs;   // Latest start of the next POLL slot, for the bulk lane
+    int64_t m_wireIdleUs;       // When the frames this task queued will have left the wire
+    uint32_t m_idleSlots;       // Idle slots in a row
+    int64_t m_cycleStartUs;
+    volatile uint32_t m_slotCount;
+    volatile uint32_t m_skippedSlots;
+    volatile uint32_t m_endedSlots;
+    volatile uint32_t m_slotOverruns;
+    volatile uint32_t m_breakCount;
+    volatile uint32_t m_slotUses[static_cast<size_t>(BusSchedule::SlotUse::COUNT)];
+    LatencyHistogram m_slotJitter;
+    LatencyHistogram m_slotOverrun;
+    LatencyHistogram m_cycleTime;
+    
+    // Backing storage for the FreeRTOS objects, so initialize() does not
+    // touch the heap (ESP-IDF stack depths are in bytes). Only one slot is
+    // ever armed, so the slot queue holds one.
+    static constexpr UBaseType_t SLOT_QUEUE_LENGTH = 1;
+    uint8_t m_slotQueueStorage[SLOT_QUEUE_LENGTH * sizeof(SlotStart)];
+    StaticQueue_t m_slotQueueBuffer;
+    StaticSemaphore_t m_slavesMutexBuffer;
+    StaticTask_t m_taskBuffer;
+    StackType_t m_taskStack[StackSizes::SLAVE_MANAGER];
+    
     // Task functions
     static void taskFunction(void* parameter);
-    static void pingTimerCallback(TimerHandle_t timer);
+    static void slotTimerCallback(void* arg);
     
     // Internal methods
     void handleTask();
-    void processPingCycle();
-    void processConfigurationStep(uint8_t address);
-    void handleIncomingMessage(const RS485Communication::Message& message);
+    void startNextSlot();       // Slot timer callback
+    int64_t runSlot(const SlotStart& slot);     // Returns the next slot's start
+    void armSlot(uint8_t index, int64_t startUs);
+    void noteWireTime(uint32_t wireUs);
+    BusSchedule::SlotUse processPingCycle();
+    bool queueLevel(const CommandCoalescer::Entry& entry);
+    bool dispatchLevelFrame();
+    void noteTargetLevel(const CommandCoalescer::Entry& entry);     // Caller holds m_slavesMutex
+    bool submitLevelFrame(RS485Communication::Message* frame,
+                          const CommandCoalescer::Entry* batch, size_t count);   // Caller holds m_slavesMutex
+    void checkSceneRecall();
+    void markSentDeliveries(const CommandCoalescer::Entry* batch, size_t count);    // Caller holds m_slavesMutex
+    void settleDeliveries(uint8_t address, const SlaveInfo& slave, bool answered);  // Caller holds m_slavesMutex
+    void reportDeliveries();
+    size_t handleIncomingMessage(const RS485Communication::Message& message);
+    void handleFrame(const CrestronFrameParser::Frame& frame, int64_t timestampUs);
+    void dispatchEvent(const InboundEvent& event);
+    ReplyMatch matchReply(const CrestronFrameParser::Frame& frame, int64_t timestampUs) const;
     
     // Configuration helpers
-    void initializeConfigTemplates();
-    bool sendConfigurationSequence(uint8_t address, ConfigStep step);
-    void advanceConfigurationStep(uint8_t address);
+    static const ConfigSequences::Sequence& sequenceFor(SlaveType type);
+    bool advanceConfigurations();
+    bool processConfigurationStep(uint8_t address, SlaveInfo& slave, TickType_t now);
     
     // Communication helpers
-    bool sendPingToSlave(uint8_t address);
-    bool sendTimeSync(uint8_t address);
+    RS485Communication::TransactionResult pollAddress(uint8_t address);
+    RS485Communication::TransactionResult sendPingToSlave(uint8_t address);
     void updateSlaveState(uint8_t address, SlaveState newState);
     
     // Timing and scheduling
     void scheduleNextPing();
-    bool isPingTimeout(const SlaveInfo& slave) const;
+    SlaveInfo* selectSlaveToPoll(TickType_t now, uint8_t& address);
+    bool nextProbeAddress(TickType_t now, uint8_t& address);  // Caller holds m_slavesMutex
+    void probeAddress(uint8_t address);
+    static SlaveType typeHintFor(uint8_t address);
+    static SlaveInfo makeSlaveInfo(uint8_t address, SlaveType type);
+    void publishSnapshot();     // Caller holds m_slavesMutex
+    void recordPollOutcome(uint8_t address, SlaveInfo& slave, bool answered,
+                           uint32_t turnaroundUs, TickType_t now);   // Caller holds m_slavesMutex
     void handlePingTimeout(uint8_t address);
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <stdint.h>
+#include "CrestronFrameParser.h"
+
+/**
+ * Simulated Crestron slaves for the native build
+ *
+ * Opens the far end of a PtyTransport and answers pings for a contiguous
+ * range of addresses with the [0x02] [0x00] ping reply a fixed turnaround
+ * after the request has finished on the (simulated) wire. A pty delivers the
+ * master's bytes at once, so airtime at the bus baud rate is simulated. A drop
+ * rate makes some pings go unanswered so the timeout and re-ping paths get
+ * exercised as well. With requestConfig each slave answers its first ping
+ * with a configuration request, the way a dimmer does after power-up.
+ * inputsPerSecond spreads input changes over the slaves; each one is
+ * reported as a digital join in place of the slave's next ping reply.
+ * The last flakySlaves of the range miss FLAKY_DROP_PERCENT of their pings
+ * on top of that, like a device on a marginal stub.
+ */
+class SlaveSimulator {
+public:
+    struct Options {
+        uint8_t firstAddress;
+        uint8_t slaveCount;
+        uint32_t baudRate;
+        uint32_t turnaroundUs;
+        uint8_t dropPercent;
+        bool requestConfig;
+        uint32_t inputsPerSecond;
+        uint8_t flakySlaves;
+    };
+    
+    static constexpr uint32_t FLAKY_DROP_PERCENT = 50;
+
+    SlaveSimulator();
+    ~SlaveSimulator();
+
+    bool start(const char* path, const Options& options);
+    void stop();
+
+    // Statistics
+    uint32_t getPingCount() const { return m_pingCount; }
+    uint32_t getReplyCount() const { return m_replyCount; }
+    uint32_t getCommandCount() const { return m_commandCount; }
+    uint32_t getConfiguredCount() const { return m_configuredCount; }
+    uint32_t getInputCount() const { return m_inputCount; }         // Changes generated
+    uint32_t getReportedInputCount() const { return m_reportedInputCount; }
+    
+    // When the input change last reported by a slave happened (esp_timer us)
+    int64_t getReportedInputTime(uint8_t address) const { return m_reportedInputUs[address]; }
+
+private:
+    int m_fd;
+    Options m_options;
+    CrestronFrameParser m_parser;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    std::atomic<uint32_t> m_pingCount;
+    std::atomic<uint32_t> m_replyCount;
+    std::atomic<uint32_t> m_commandCount;
+    std::atomic<uint32_t> m_configuredCount;     // Slaves that received the closing config frame
+    bool m_configRequested[256];                 // Simulator thread only
+    
+    // Input changes waiting for the slave's next poll; a newer change
+    // replaces one not yet reported (simulator thread only)
+    struct PendingInput {
+        bool pending;
+        uint8_t join;
+        bool pressed;
+        int64_t changedUs;
+    };
+    PendingInput m_inputs[256];
+    int64_t m_inputStartUs;
+    std::atomic<uint32_t> m_inputCount;
+    std::atomic<uint32_t> m_reportedInputCount;
+    std::atomic<int64_t> m_reportedInputUs[256];
+
+    void run();
+    void handleFrame(const CrestronFrameParser::Frame& frame);
+    bool isSimulated(uint8_t address) const;
+    void generateInputs();
+};
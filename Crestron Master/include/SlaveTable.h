@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Slave records indexed directly by Cresnet address
+ * All 256 slots are allocated up front, so lookups from a reply's address are
+ * a single index and nothing touches the heap after construction. A sorted
+ * array of the addresses in use drives round-robin polling in address order;
+ * adding or removing a slave shifts that array, which only happens on
+ * (re)configuration. Not thread-safe: SlaveManager guards it with its mutex.
+ */
+template <typename T>
+class SlaveTable {
+public:
+    static constexpr size_t CAPACITY = 256;
+
+    SlaveTable() : m_count(0), m_cursor(0) {
+        for (size_t i = 0; i < CAPACITY; i++) {
+            m_present[i] = false;
+        }
+    }
+
+    T* find(uint8_t address) { return m_present[address] ? &m_entries[address] : nullptr; }
+    const T* find(uint8_t address) const { return m_present[address] ? &m_entries[address] : nullptr; }
+
+    // Insert or replace the entry for an address
+    void insert(uint8_t address, const T& entry) {
+        m_entries[address] = entry;
+        if (m_present[address]) return;
+
+        size_t position = m_count;
+        while (position > 0 && m_active[position - 1] > address) {
+            m_active[position] = m_active[position - 1];
+            position--;
+        }
+        m_active[position] = address;
+        m_present[address] = true;
+        m_count++;
+
+        // Keep the cursor on the same slave it pointed at
+        if (position < m_cursor) m_cursor++;
+    }
+
+    bool erase(uint8_t address) {
+        if (!m_present[address]) return false;
+
+        size_t position = 0;
+        while (m_active[position] != address) {
+            position++;
+        }
+        for (size_t i = position + 1; i < m_count; i++) {
+            m_active[i - 1] = m_active[i];
+        }
+        m_present[address] = false;
+        m_count--;
+
+        if (position < m_cursor) m_cursor--;
+        if (m_cursor >= m_count) m_cursor = 0;
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < m_count; i++) {
+            m_present[m_active[i]] = false;
+        }
+        m_count = 0;
+        m_cursor = 0;
+    }
+
+    // Next slave in round-robin order, or nullptr when the table is empty
+    T* next(uint8_t& address) {
+        if (m_count == 0) return nullptr;
+
+        address = m_active[m_cursor];
+        m_cursor = (m_cursor + 1 < m_count) ? m_cursor + 1 : 0;
+        return &m_entries[address];
+    }
+
+    // Next slave in round-robin order for which eligible(entry) holds,
+    // skipping the rest; nullptr if none qualifies in a full lap
+    template <typename Predicate>
+    T* next(uint8_t& address, Predicate eligible) {
+        for (size_t scanned = 0; scanned < m_count; scanned++) {
+            uint8_t candidate = m_active[m_cursor];
+            m_cursor = (m_cursor + 1 < m_count) ? m_cursor + 1 : 0;
+            if (eligible(m_entries[candidate])) {
+                address = candidate;
+                return &m_entries[candidate];
+            }
+        }
+        return nullptr;
+    }
+
+    // Iteration over slaves in use, in address order
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    uint8_t addressAt(size_t index) const { return m_active[index]; }
+    T& at(size_t index) { return m_entries[m_active[index]]; }
+    const T& at(size_t index) const { return m_entries[m_active[index]]; }
+
+private:
+    T m_entries[CAPACITY];
+    bool m_present[CAPACITY];
+    uint8_t m_active[CAPACITY];
+    uint16_t m_count;
+    uint16_t m_cursor;
+};
@@ -6,5 +6,7 @@
 namespace UI {
     void begin();
     void showStartup();
-    void updateMainScreen(bool pingEnabled, uint32_t heap, uint32_t tx, uint32_t rx, uint32_t err, uint32_t successPings, uint32_t totalPings, const uint8_t* slaveAddresses, const char** slaveNames, int slaveCount, bool dim1, bool dim2);
+    // missedPercent and onProbation are per slave, from the link statistics
+    void updateMainScreen(bool pingEnabled, uint32_t heap, uint32_t tx, uint32_t rx, uint32_t err, uint32_t successPings, uint32_t totalPings, const uint8_t* slaveAddresses, const char** slaveNames, const uint8_t* missedPercent, const bool* onProbation, int slaveCount, bool dim1, bool dim2);
+    void showLatency(const char* label, uint32_t p50, uint32_t p95, uint32_t p99, uint32_t max);
 }
@@ -8,12 +8,14 @@
 
 // Timing constants for Crestron protocol
 namespace CrestronTiming {
-    constexpr uint32_t PING_INTERVAL_MS = 23;
-    constexpr uint32_t PING_TIMEOUT_MS = 4;
-    constexpr uint32_t REPING_DELAY_MS = 320;
+    constexpr uint32_t PING_TIMEOUT_US = 4000;     // From end of our transmit to reply delimited
+    constexpr uint32_t REPING_DELAY_MS = 320;         // First retry after a missed ping; doubles per miss
+    constexpr uint32_t MAX_REPING_DELAY_MS = 5120;    // Backoff ceiling for slaves that stay silent
     constexpr uint32_t CONFIG_STEP_DELAY_MS = 2;
     constexpr uint32_t INTER_COMMAND_DELAY_MS = 4;
     constexpr uint32_t BREAK_DURATION_US = 260;
+    constexpr uint32_t POLL_GRACE_US = 2000;       // Bulk frames wait this long past a missed poll deadline
+    constexpr uint32_t BULK_MAX_WAIT_US = 20000;   // A bulk frame queued this long goes ahead of control frames
 }
 
 // RS485 communication settings
@@ -25,6 +27,51 @@ namespace RS485Config {
     constexpr uart_word_length_t DATA_BITS = UART_DATA_8_BITS;
     constexpr uart_parity_t PARITY = UART_PARITY_DISABLE;
     constexpr uart_stop_bits_t STOP_BITS = UART_STOP_BITS_2;
+
+    // Idle gap (in character times) after which the UART raises its RX-timeout
+    // interrupt; this is what delimits one on-wire frame from the next
+    constexpr uint8_t RX_IDLE_TIMEOUT_SYMBOLS = 2;
+    constexpr int UART_EVENT_QUEUE_SIZE = 32;
+
+    // Bus capture ring: PSRAM when fitted, otherwise a small internal buffer
+    constexpr size_t CAPTURE_PSRAM_BYTES = 1024 * 1024;
+    constexpr size_t CAPTURE_INTERNAL_BYTES = 16 * 1024;
+
+    // Per-slave turnaround histograms (about 400 bytes each) for the first
+    // slaves to reply; later addresses are counted as dropped
+    constexpr size_t TURNAROUND_HISTOGRAMS = 16;
+}
+
+// Per-bus settings; each bus gets its own UART, tasks and SlaveManager
+struct BusSettings {
+    const char* name;
+    uart_port_t port;
+    uint8_t txPin;
+    uint8_t rxPin;
+    uint8_t dePin;
+    uint32_t baudRate;
+    uint8_t rxIdleTimeoutSymbols;
+    uint32_t pingTimeoutUs;
+    BaseType_t core;            // Core the bus's RX/TX and SlaveManager tasks run on
+};
+
+// Number of buses brought up at boot; set -DCRESTRON_BUS_COUNT=2 for two segments
+#ifndef CRESTRON_BUS_COUNT
+#define CRESTRON_BUS_COUNT 1
+#endif
+
+namespace RS485Config {
+    constexpr BusSettings BUSES[] = {
+        {"bus1", UART_NUM_2, TX_PIN, RX_PIN, DE_RE_PIN, BAUD_RATE, RX_IDLE_TIMEOUT_SYMBOLS,
+         CrestronTiming::PING_TIMEOUT_US, 1},
+        // Second segment on UART1; pins must match the second transceiver's wiring
+        {"bus2", UART_NUM_1, 26, 36, 25, BAUD_RATE, RX_IDLE_TIMEOUT_SYMBOLS,
+         CrestronTiming::PING_TIMEOUT_US, 0},
+    };
+
+    constexpr size_t BUS_COUNT = CRESTRON_BUS_COUNT;
+    static_assert(BUS_COUNT >= 1 && BUS_COUNT <= sizeof(BUSES) / sizeof(BUSES[0]),
+                  "CRESTRON_BUS_COUNT exceeds the buses defined in RS485Config::BUSES");
 }
 
 // Slave device definitions
@@ -33,6 +80,40 @@ namespace SlaveDevices {
     constexpr uint8_t DIM8_ADDRESS = 0x0B;
     constexpr uint8_t DIMU8_ADDRESS = 0x0C;
     constexpr uint8_t MAX_SLAVES = 3;
+    constexpr uint8_t DIMMER_CHANNELS = 8;
+}
+
+// Background search for slaves that are not in the table
+namespace DiscoveryConfig {
+    constexpr uint8_t FIRST_ADDRESS = 0x03;    // 0x00 is unused, 0x02 is the to-master prefix
+    constexpr uint8_t LAST_ADDRESS = 0xFE;
+    constexpr uint32_t SLOT_SHARE = 16;        // At most one probe per this many poll cycles while slaves are due
+}
+
+// Per-slave link quality. A slave that misses too many polls leaves the
+// normal rotation for a slow probation cadence until it answers reliably
+namespace LinkQuality {
+    constexpr uint32_t EWMA_SHIFT = 4;                 // Each poll moves the averages 1/16 of the way
+    constexpr uint16_t RATIO_SCALE = 1000;             // Timeout ratio in parts per thousand
+    constexpr uint16_t PROBATION_ENTER_RATIO = 250;    // Over a quarter of recent polls missed
+    constexpr uint16_t PROBATION_EXIT_RATIO = 50;      // Back under one in twenty
+    constexpr uint32_t PROBATION_POLL_MS = 500;        // At most one poll this often while on probation
+    constexpr uint32_t MIN_POLLS = 16;                 // Polls before the ratio is trusted
+}
+
+// Acknowledged level commands
+namespace DeliveryConfig {
+    constexpr size_t MAX_TRACKED = 32;         // Acked levels in flight per bus
+    constexpr uint8_t MAX_ATTEMPTS = 4;        // Sends per level, the first included
+}
+
+// Stored lighting scenes
+namespace SceneConfig {
+    constexpr size_t MAX_SCENES = 16;
+    constexpr size_t MAX_TARGETS = 64;         // CommandCoalescer holds two scenes' worth of levels
+    constexpr size_t NAME_LENGTH = 16;         // Including the terminator
+    constexpr const char* NVS_NAMESPACE = "scenes";
+    constexpr uint32_t RECALL_TIMEOUT_MS = 2000;  // Stop waiting for a recall's frames
 }
 
 // Message types and protocol constants
@@ -44,8 +125,17 @@ namespace CrestronProtocol {
     constexpr uint8_t DIM_COMMAND = 0x1D;
     constexpr uint8_t DIMU_COMMAND = 0x20;
     
+    // A DIM/DIMU ramp frame is [0x1D] [0x00] followed by one 6-byte entry per
+    // channel: ramp (2), 0x00, level, channel, level. The setup frames carry
+    // eight channel entries each, so batches are capped at eight as well.
+    // Runtime level changes have only been seen one channel per frame, so
+    // that is the default; multi-entry frames are opt-in per bus.
+    constexpr size_t DIM_ENTRY_LENGTH = 6;
+    constexpr size_t MAX_LEVELS_PER_FRAME = 8;
+    constexpr size_t DEFAULT_LEVELS_PER_FRAME = 1;
+    
     constexpr size_t MAX_MESSAGE_LENGTH = 128;
-    constexpr size_t MESSAGE_QUEUE_SIZE = 32;
+    constexpr size_t FRAME_POOL_SIZE = 16;     // Per direction; must be a power of two
 }
 
 // Task priorities (higher number = higher priority)
@@ -57,7 +147,8 @@ namespace TaskPriorities {
     constexpr UBaseType_t STATUS_MONITOR = 1;
 }
 
-// Stack sizes for tasks (in words, not bytes)
+// Stack sizes for tasks, in bytes: ESP-IDF's FreeRTOS takes stack depths in
+// bytes, and StackType_t is one byte, so these also size the static stacks
 namespace StackSizes {
     constexpr uint32_t RS485_HANDLER = 4096;
     constexpr uint32_t SLAVE_MANAGER = 3072;
@@ -0,0 +1,32 @@
+#pragma once
+
+// Minimal Arduino core for the native build: timing and Print only
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/uart.h>
+#include <esp_timer.h>
+
+inline unsigned long millis() { return static_cast<unsigned long>(esp_timer_get_time() / 1000); }
+inline unsigned long micros() { return static_cast<unsigned long>(esp_timer_get_time()); }
+inline void delay(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+};
+
+// Print onto a stdio stream (stdout for binary dumps)
+class FilePrint : public Print {
+public:
+    explicit FilePrint(FILE* file) : m_file(file) {}
+    size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, m_file); }
+
+private:
+    FILE* m_file;
+};
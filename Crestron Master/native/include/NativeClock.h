@@ -0,0 +1,20 @@
+#pragma once
+
+/**
+ * Simulated time for the native build (used by --replay)
+ *
+ * By default the shim runs on the host's clock. After useVirtualTime(),
+ * esp_timer_get_time(), tick counts, delays, timers and every timed FreeRTOS
+ * wait follow a simulated clock instead. It only moves when every counted
+ * thread is blocked, and then jumps straight to the earliest deadline, so a
+ * run takes as long as its computation and is the same on every host.
+ *
+ * Tasks and timers are counted from creation. Other threads that block
+ * through the shim (main) call attachThread() first.
+ */
+namespace NativeClock {
+    // Before any task, timer or queue wait exists
+    void useVirtualTime();
+    bool isVirtual();
+    void attachThread();
+}
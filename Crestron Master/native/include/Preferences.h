@@ -0,0 +1,25 @@
+#pragma once
+
+// Arduino Preferences (NVS) for the native build: kept in memory for the
+// life of the process
+#include <stddef.h>
+#include <stdint.h>
+
+class Preferences {
+public:
+    Preferences() : m_namespace(nullptr), m_readOnly(true) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false);
+    void end() { m_namespace = nullptr; }
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t getBytesLength(const char* key);
+    bool isKey(const char* key);
+    bool remove(const char* key);
+
+private:
+    const char* m_namespace;
+    bool m_readOnly;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdio.h>
+
+// ESP_LOGx shim: printed to stderr, filtered by CORE_DEBUG_LEVEL like the
+// Arduino-ESP32 core (1 = error ... 5 = verbose)
+#ifndef CORE_DEBUG_LEVEL
+#define CORE_DEBUG_LEVEL 3
+#endif
+
+#define ESP_SHIM_LOG(level, letter, tag, format, ...) \
+    do { \
+        if (CORE_DEBUG_LEVEL >= level) { \
+            fprintf(stderr, "[" letter "][%s] " format "\n", tag, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_SHIM_LOG(1, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_SHIM_LOG(2, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_SHIM_LOG(3, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_SHIM_LOG(4, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_SHIM_LOG(5, "V", tag, format, ##__VA_ARGS__)
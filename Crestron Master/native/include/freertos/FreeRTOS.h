@@ -0,0 +1,47 @@
+#pragma once
+
+// FreeRTOS compatibility shim for the native (Linux) build
+// Tasks are std::threads, ticks are milliseconds since start-up, and
+// critical sections are plain mutexes. Only what the master uses is provided.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_TASK_NAME_LEN 16
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+struct portMUX_TYPE {
+    std::mutex mutex;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->mutex.lock()
+#define portEXIT_CRITICAL(mux) (mux)->mutex.unlock()
+
+typedef struct ShimTask* TaskHandle_t;
+typedef struct ShimQueue* QueueHandle_t;
+typedef struct ShimQueue* SemaphoreHandle_t;
+typedef struct ShimTimer* TimerHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Buffers for the *Static creation functions. The shim still allocates its
+// own objects (threads need heap anyway); these only keep the API identical.
+struct StaticTask_t { void* reserved; };
+struct StaticQueue_t { void* reserved; };
+struct StaticTimer_t { void* reserved; };
+typedef StaticQueue_t StaticSemaphore_t;
@@ -0,0 +1,150 @@
+#include "BusCapture.h"
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+static const char* TAG = "BusCapture";
+
+BusCapture::BusCapture()
+    : m_buffer(nullptr)
+    , m_capacity(0)
+    , m_head(0)
+    , m_tail(0)
+    , m_used(0)
+    , m_recordCount(0)
+    , m_droppedCount(0)
+    , m_enabled(false)
+    , m_inPsram(false)
+    , m_lock(portMUX_INITIALIZER_UNLOCKED)
+{
+}
+
+BusCapture::~BusCapture() {
+    end();
+}
+
+bool BusCapture::begin(size_t psramBytes, size_t internalBytes) {
+    if (m_buffer) return true;
+
+    m_buffer = static_cast<uint8_t*>(heap_caps_malloc(psramBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (m_buffer) {
+        m_capacity = psramBytes;
+        m_inPsram = true;
+    } else {
+        m_buffer = static_cast<uint8_t*>(heap_caps_malloc(internalBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+        if (!m_buffer) {
+            ESP_LOGE(TAG, "Failed to allocate capture buffer");
+            return false;
+        }
+        m_capacity = internalBytes;
+        m_inPsram = false;
+    }
+
+    clear();
+    ESP_LOGI(TAG, "Capture buffer: %d bytes in %s", static_cast<int>(m_capacity), m_inPsram ? "PSRAM" : "internal RAM");
+    return true;
+}
+
+void BusCapture::end() {
+    setEnabled(false);
+
+    if (m_buffer) {
+        heap_caps_free(m_buffer);
+        m_buffer = nullptr;
+        m_capacity = 0;
+    }
+}
+
+void BusCapture::setEnabled(bool enabled) {
+    portENTER_CRITICAL(&m_lock);
+    m_enabled = enabled && m_buffer != nullptr;
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void BusCapture::record(uint8_t flags, int64_t timestampUs, const uint8_t* data, size_t length) {
+    if (!m_enabled || length > 255) return;
+
+    const size_t recordSize = RECORD_HEADER_SIZE + length;
+    const uint32_t timestamp = static_cast<uint32_t>(timestampUs);
+    const uint8_t header[RECORD_HEADER_SIZE] = {
+        static_cast<uint8_t>(timestamp),
+        static_cast<uint8_t>(timestamp >> 8),
+        static_cast<uint8_t>(timestamp >> 16),
+        static_cast<uint8_t>(timestamp >> 24),
+        flags,
+        static_cast<uint8_t>(length)
+    };
+
+    portENTER_CRITICAL(&m_lock);
+    if (m_enabled && recordSize <= m_capacity) {
+        while (m_capacity - m_used < recordSize) {
+            dropOldest();
+        }
+        writeBytes(header, sizeof(header));
+        writeBytes(data, length);
+        m_used += recordSize;
+        m_recordCount++;
+    }
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void BusCapture::clear() {
+    portENTER_CRITICAL(&m_lock);
+    m_head = 0;
+    m_tail = 0;
+    m_used = 0;
+    m_recordCount = 0;
+    m_droppedCount = 0;
+    portEXIT_CRITICAL(&m_lock);
+}
+
+size_t BusCapture::dump(Print& out, uint32_t baudRate) {
+    // Pause recording so the buffer holds still while it is streamed out;
+    // serial output is far too slow to do under the spinlock
+    portENTER_CRITICAL(&m_lock);
+    const bool wasEnabled = m_enabled;
+    m_enabled = false;
+    portEXIT_CRITICAL(&m_lock);
+
+    const uint32_t fields[] = {FILE_MAGIC, 0, baudRate, m_recordCount, static_cast<uint32_t>(m_used)};
+    uint8_t header[sizeof(fields)];
+    static_assert(sizeof(header) == FILE_HEADER_SIZE, "Dump header layout changed");
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        header[i * 4 + 0] = static_cast<uint8_t>(fields[i]);
+        header[i * 4 + 1] = static_cast<uint8_t>(fields[i] >> 8);
+        header[i * 4 + 2] = static_cast<uint8_t>(fields[i] >> 16);
+        header[i * 4 + 3] = static_cast<uint8_t>(fields[i] >> 24);
+    }
+    header[4] = FORMAT_VERSION;
+
+    size_t written = out.write(header, sizeof(header));
+
+    // Oldest data first: up to the end of the buffer, then the wrapped part
+    if (m_used > 0) {
+        size_t firstPart = m_capacity - m_tail;
+        if (firstPart > m_used) firstPart = m_used;
+        written += out.write(m_buffer + m_tail, firstPart);
+        written += out.write(m_buffer, m_used - firstPart);
+    }
+
+    setEnabled(wasEnabled);
+    return written;
+}
+
+void BusCapture::writeBytes(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        m_buffer[m_head] = data[i];
+        m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+    }
+}
+
+uint8_t BusCapture::byteAt(size_t offset) const {
+    return m_buffer[(m_tail + offset) % m_capacity];
+}
+
+void BusCapture::dropOldest() {
+    const size_t recordSize = RECORD_HEADER_SIZE + byteAt(RECORD_HEADER_SIZE - 1);
+    m_tail = (m_tail + recordSize) % m_capacity;
+    m_used -= recordSize;
+    m_recordCount--;
+    m_droppedCount++;
+}
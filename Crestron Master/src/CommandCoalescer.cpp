@@ -0,0 +1,100 @@
+#include "CommandCoalescer.h"
+
+CommandCoalescer::CommandCoalescer()
+    : m_count(0)
+    , m_lock(portMUX_INITIALIZER_UNLOCKED)
+    , m_postedCount(0)
+    , m_coalescedCount(0)
+    , m_takenCount(0)
+    , m_rejectedCount(0)
+{
+}
+
+bool CommandCoalescer::post(const Entry& entry) {
+    bool accepted = true;
+
+    portENTER_CRITICAL(&m_lock);
+    m_postedCount++;
+
+    size_t index = findLocked(entry.address, entry.channel);
+    if (index < m_count) {
+        // Superseded before it reached the wire; the newest level (and kind,
+        // ramp) replaces it
+        m_entries[index] = entry;
+        m_coalescedCount++;
+    } else if (m_count < CAPACITY) {
+        m_entries[m_count] = entry;
+        m_count++;
+    } else {
+        m_rejectedCount++;
+        accepted = false;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return accepted;
+}
+
+size_t CommandCoalescer::takeBatch(Entry* entries, size_t maxCount) {
+    size_t taken = 0;
+
+    portENTER_CRITICAL(&m_lock);
+    if (m_count > 0 && maxCount > 0) {
+        const Entry first = m_entries[0];
+        size_t kept = 0;
+
+        // One pass: matching entries move out, the rest close up in order
+        for (size_t i = 0; i < m_count; i++) {
+            const Entry& entry = m_entries[i];
+            if (taken < maxCount && entry.address == first.address && entry.kind == first.kind) {
+                entries[taken++] = entry;
+            } else {
+                m_entries[kept++] = entry;
+            }
+        }
+        m_count = kept;
+        m_takenCount += taken;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return taken;
+}
+
+void CommandCoalescer::restoreBatch(const Entry* entries, size_t count) {
+    // Restored back to front so the batch regains its original order
+    for (size_t i = count; i > 0; i--) {
+        restore(entries[i - 1]);
+    }
+}
+
+void CommandCoalescer::restore(const Entry& entry) {
+    portENTER_CRITICAL(&m_lock);
+    if (findLocked(entry.address, entry.channel) >= m_count && m_count < CAPACITY) {
+        // Back to the head of the line it was taken from
+        for (size_t i = m_count; i > 0; i--) {
+            m_entries[i] = m_entries[i - 1];
+        }
+        m_entries[0] = entry;
+        m_count++;
+    }
+    m_takenCount--;
+    portEXIT_CRITICAL(&m_lock);
+}
+
+bool CommandCoalescer::pendingLevel(uint8_t address, uint8_t channel, uint8_t& level) const {
+    portENTER_CRITICAL(&m_lock);
+    size_t index = findLocked(address, channel);
+    bool found = index < m_count;
+    if (found) level = m_entries[index].level;
+    portEXIT_CRITICAL(&m_lock);
+
+    return found;
+}
+
+size_t CommandCoalescer::findLocked(uint8_t address, uint8_t channel) const {
+    for (size_t i = 0; i < m_count; i++) {
+        if (m_entries[i].address == address && m_entries[i].channel == channel) {
+            return i;
+        }
+    }
+    return m_count;
+}
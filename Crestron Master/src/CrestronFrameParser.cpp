@@ -0,0 +1,92 @@
+#include "CrestronFrameParser.h"
+#include <string.h>
+
+namespace {
+    // Same values as CrestronProtocol in config.h; repeated here so the parser
+    // does not pull in the Arduino/FreeRTOS headers and stays host-buildable
+    constexpr uint8_t TO_MASTER_PREFIX = 0x02;
+    constexpr uint8_t PING_COMMAND = 0x00;
+    constexpr uint8_t IDLE_FILL = 0xFF;     // Line noise / idle bus read as a byte
+}
+
+CrestronFrameParser::CrestronFrameParser()
+    : m_state(State::IDLE)
+    , m_frameReady(false)
+    , m_polledAddress(0)
+    , m_received(0)
+    , m_frameCount(0)
+    , m_skippedByteCount(0)
+{
+    memset(&m_frame, 0, sizeof(m_frame));
+}
+
+size_t CrestronFrameParser::feed(const uint8_t* data, size_t length) {
+    m_frameReady = false;
+
+    size_t consumed = 0;
+    while (consumed < length && !m_frameReady) {
+        if (m_state == State::PAYLOAD) {
+            // Copy as much of the payload as this span holds in one go
+            size_t wanted = m_frame.length - m_received;
+            size_t available = length - consumed;
+            size_t count = wanted < available ? wanted : available;
+            memcpy(&m_frame.payload[m_received], &data[consumed], count);
+            m_received += count;
+            consumed += count;
+
+            if (m_received == m_frame.length) {
+                completeFrame();
+            }
+            continue;
+        }
+
+        const uint8_t byte = data[consumed++];
+
+        if (m_state == State::IDLE) {
+            if (byte == TO_MASTER_PREFIX) {
+                m_frame.direction = Direction::SLAVE_TO_MASTER;
+                m_frame.address = m_polledAddress;
+                m_state = State::LENGTH;
+            } else if (byte != IDLE_FILL && byte != PING_COMMAND) {
+                m_frame.direction = Direction::MASTER_TO_SLAVE;
+                m_frame.address = byte;
+                m_state = State::LENGTH;
+            } else {
+                // Break NULs and idle fill between frames
+                m_skippedByteCount++;
+            }
+        } else if (byte == PING_COMMAND) {
+            m_frame.isPing = true;
+            m_frame.length = 0;
+            completeFrame();
+        } else {
+            m_frame.isPing = false;
+            m_frame.length = byte;
+            m_received = 0;
+            m_state = State::PAYLOAD;
+        }
+    }
+
+    return consumed;
+}
+
+void CrestronFrameParser::reset() {
+    if (m_state != State::IDLE) {
+        m_skippedByteCount += (m_state == State::PAYLOAD) ? 2 + m_received : 1;
+    }
+    m_state = State::IDLE;
+    m_received = 0;
+    m_frameReady = false;
+}
+
+void CrestronFrameParser::completeFrame() {
+    if (m_frame.direction == Direction::MASTER_TO_SLAVE) {
+        // Replies that follow belong to whoever the master just addressed
+        m_polledAddress = m_frame.address;
+    }
+
+    m_state = State::IDLE;
+    m_received = 0;
+    m_frameReady = true;
+    m_frameCount++;
+}
@@ -0,0 +1,106 @@
+#include "Esp32UartTransport.h"
+
+Esp32UartTransport::Esp32UartTransport()
+    : m_eventQueue(nullptr)
+{
+}
+
+Esp32UartTransport::~Esp32UartTransport() {
+    close();
+}
+
+bool Esp32UartTransport::open(const BusSettings& settings) {
+    RS485Port::Config config;
+    config.port = settings.port;
+    config.txPin = settings.txPin;
+    config.rxPin = settings.rxPin;
+    config.dePin = settings.dePin;
+    config.baudRate = settings.baudRate;
+    config.dataBits = RS485Config::DATA_BITS;
+    config.parity = RS485Config::PARITY;
+    config.stopBits = RS485Config::STOP_BITS;
+    config.rxBufferSize = RX_BUFFER_SIZE;
+    config.txBufferSize = TX_BUFFER_SIZE;
+    config.eventQueueSize = RS485Config::UART_EVENT_QUEUE_SIZE;
+    // RX-timeout interrupt marks the end of a frame once the line goes idle
+    config.rxTimeoutSymbols = settings.rxIdleTimeoutSymbols;
+
+    if (!m_port.begin(config)) {
+        return false;
+    }
+
+    m_eventQueue = m_port.eventQueue();
+    return true;
+}
+
+void Esp32UartTransport::close() {
+    m_port.end();
+    m_eventQueue = nullptr; // Owned and freed by the UART driver
+}
+
+bool Esp32UartTransport::waitEvent(Event& event, TickType_t timeout) {
+    uart_event_t uartEvent;
+    if (!m_eventQueue || xQueueReceive(m_eventQueue, &uartEvent, timeout) != pdTRUE) {
+        return false;
+    }
+
+    event.size = 0;
+    event.frameEnd = false;
+
+    switch (uartEvent.type) {
+        case UART_DATA:
+            event.type = EventType::DATA;
+            event.size = uartEvent.size;
+            // timeout_flag is set when the RX-timeout interrupt fired
+            event.frameEnd = uartEvent.timeout_flag;
+            break;
+        case UART_FIFO_OVF:
+            event.type = EventType::FIFO_OVERFLOW;
+            break;
+        case UART_BUFFER_FULL:
+            event.type = EventType::BUFFER_FULL;
+            break;
+        case UART_FRAME_ERR:
+            event.type = EventType::FRAME_ERROR;
+            break;
+        case UART_PARITY_ERR:
+            event.type = EventType::PARITY_ERROR;
+            break;
+        default:
+            event.type = EventType::OTHER;
+            break;
+    }
+
+    return true;
+}
+
+int Esp32UartTransport::read(uint8_t* buffer, size_t length) {
+    return m_port.read(buffer, length, 0);
+}
+
+void Esp32UartTransport::flushInput() {
+    m_port.flushInput();
+}
+
+void Esp32UartTransport::discardInput() {
+    m_port.flushInput();
+    if (m_eventQueue) {
+        xQueueReset(m_eventQueue);
+    }
+}
+
+int Esp32UartTransport::write(const uint8_t* data, size_t length) {
+    return m_port.write(data, length);
+}
+
+int Esp32UartTransport::writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) {
+    return m_port.writeWithBreak(data, length, breakBits);
+}
+
+bool Esp32UartTransport::waitTxDone(TickType_t timeout) {
+    return m_port.waitTxDone(timeout);
+}
+
+bool Esp32UartTransport::collisionDetected() {
+    return m_port.collisionDetected();
+}
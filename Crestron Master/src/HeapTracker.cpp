@@ -0,0 +1,120 @@
+#include "HeapTracker.h"
+
+#if CRESTRON_HEAP_TRACKING
+
+#include <freertos/task.h>
+#include <string.h>
+
+namespace {
+    HeapTracker::TaskCount g_tasks[HeapTracker::MAX_TASKS];
+    size_t g_taskCount = 0;
+    uint32_t g_totalCount = 0;
+    uint32_t g_untrackedCount = 0;
+    volatile bool g_armed = false;
+    portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+
+    void record(size_t size) {
+        if (!g_armed) return;
+
+        if (xPortInIsrContext()) {
+            portENTER_CRITICAL_ISR(&g_lock);
+            g_totalCount++;
+            g_untrackedCount++;
+            portEXIT_CRITICAL_ISR(&g_lock);
+            return;
+        }
+
+        TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+        portENTER_CRITICAL(&g_lock);
+        g_totalCount++;
+
+        size_t index = 0;
+        while (index < g_taskCount && g_tasks[index].task != task) {
+            index++;
+        }
+
+        if (index == g_taskCount && g_taskCount < HeapTracker::MAX_TASKS) {
+            // Copy the name now; the task may be gone when the counts are read
+            HeapTracker::TaskCount& entry = g_tasks[g_taskCount++];
+            entry.task = task;
+            strncpy(entry.name, pcTaskGetName(task), sizeof(entry.name) - 1);
+            entry.name[sizeof(entry.name) - 1] = '\0';
+            entry.allocations = 0;
+            entry.bytes = 0;
+        }
+
+        if (index < g_taskCount) {
+            g_tasks[index].allocations++;
+            g_tasks[index].bytes += size;
+        } else {
+            g_untrackedCount++;
+        }
+        portEXIT_CRITICAL(&g_lock);
+    }
+}
+
+// Linker-wrapped entry points (-Wl,--wrap=malloc etc. in the debug env)
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_calloc(size_t count, size_t size);
+    void* __real_realloc(void* pointer, size_t size);
+
+    void* __wrap_malloc(size_t size) {
+        record(size);
+        return __real_malloc(size);
+    }
+
+    void* __wrap_calloc(size_t count, size_t size) {
+        record(count * size);
+        return __real_calloc(count, size);
+    }
+
+    void* __wrap_realloc(void* pointer, size_t size) {
+        record(size);
+        return __real_realloc(pointer, size);
+    }
+}
+
+bool HeapTracker::isEnabled() {
+    return true;
+}
+
+void HeapTracker::arm() {
+    g_armed = true;
+}
+
+void HeapTracker::reset() {
+    portENTER_CRITICAL(&g_lock);
+    g_taskCount = 0;
+    g_totalCount = 0;
+    g_untrackedCount = 0;
+    portEXIT_CRITICAL(&g_lock);
+}
+
+size_t HeapTracker::snapshot(TaskCount* counts, size_t maxCount) {
+    portENTER_CRITICAL(&g_lock);
+    size_t count = g_taskCount < maxCount ? g_taskCount : maxCount;
+    memcpy(counts, g_tasks, count * sizeof(TaskCount));
+    portEXIT_CRITICAL(&g_lock);
+    return count;
+}
+
+uint32_t HeapTracker::getTotalCount() {
+    return g_totalCount;
+}
+
+uint32_t HeapTracker::getUntrackedCount() {
+    return g_untrackedCount;
+}
+
+#else
+
+bool HeapTracker::isEnabled() { return false; }
+void HeapTracker::arm() {}
+void HeapTracker::reset() {}
+size_t HeapTracker::snapshot(TaskCount*, size_t) { return 0; }
+uint32_t HeapTracker::getTotalCount() { return 0; }
+uint32_t HeapTracker::getUntrackedCount() { return 0; }
+
+#endif
@@ -0,0 +1,69 @@
+#include "InboundDecoder.h"
+
+namespace {
+    using Event = InboundDecoder::Event;
+    using EventType = InboundDecoder::EventType;
+
+    void decodeDigital(const uint8_t* payload, Event& event) {
+        event.index = static_cast<uint16_t>(payload[1] | ((payload[2] & ~InboundDecoder::JOIN_RELEASED) << 8));
+        event.value = (payload[2] & InboundDecoder::JOIN_RELEASED) ? 0 : 1;
+    }
+
+    void decodeAnalog(const uint8_t* payload, Event& event) {
+        event.index = payload[1];
+        event.value = static_cast<uint16_t>((payload[2] << 8) | payload[3]);
+    }
+
+    struct Rule {
+        uint8_t command;            // First payload byte
+        uint8_t length;             // Exact payload length
+        EventType type;
+        void (*decode)(const uint8_t* payload, Event& event);   // nullptr: no fields
+    };
+
+    const Rule RULES[] = {
+        {InboundDecoder::CONFIG_REQUEST, 2, EventType::CONFIG_REQUEST, nullptr},
+        {InboundDecoder::DIGITAL_JOIN, 3, EventType::INPUT_CHANGE, decodeDigital},
+        {InboundDecoder::ANALOG_JOIN, 4, EventType::DIMMER_FEEDBACK, decodeAnalog},
+    };
+}
+
+bool InboundDecoder::decode(const CrestronFrameParser::Frame& frame, int64_t timestampUs, Event& event) {
+    if (frame.direction != CrestronFrameParser::Direction::SLAVE_TO_MASTER) {
+        return false;
+    }
+
+    event.type = frame.isPing ? EventType::PING_ACK : EventType::UNKNOWN;
+    event.address = frame.address;
+    event.timestampUs = timestampUs;
+    event.index = 0;
+    event.value = 0;
+    event.length = frame.length;
+    event.payload = frame.payload;
+
+    if (frame.isPing || frame.length == 0) {
+        return true;
+    }
+
+    for (const Rule& rule : RULES) {
+        if (frame.payload[0] == rule.command && frame.length == rule.length) {
+            event.type = rule.type;
+            if (rule.decode) {
+                rule.decode(frame.payload, event);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+const char* InboundDecoder::typeName(EventType type) {
+    switch (type) {
+        case EventType::PING_ACK:           return "ping ack";
+        case EventType::CONFIG_REQUEST:     return "config request";
+        case EventType::INPUT_CHANGE:       return "input change";
+        case EventType::DIMMER_FEEDBACK:    return "dimmer feedback";
+        case EventType::UNKNOWN:
+        default:                            return "unknown";
+    }
+}
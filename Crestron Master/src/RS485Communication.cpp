@@ -1,21 +1,42 @@
 #include "RS485Communication.h"
 #include <esp_log.h>
-#include <soc/uart_reg.h>
-#include <driver/gpio.h>
+#include <esp_timer.h>
 
 static const char* TAG = "RS485";
 
-RS485Communication::RS485Communication() 
-    : m_initialized(false)
-    , m_rxQueue(nullptr)
-    , m_txQueue(nullptr)
-    , m_txMutex(nullptr)
+RS485Communication::RS485Communication(BusTransport& transport, const BusSettings& settings) 
+    : m_settings(settings)
+    , m_initialized(false)
+    , m_transport(transport)
     , m_rxTaskHandle(nullptr)
     , m_txTaskHandle(nullptr)
+    , m_rxWaiter(nullptr)
+    , m_deadlineTimer(nullptr)
+    , m_txnOwner(nullptr)
+    , m_txnTxDone(false)
+    , m_txnCollision(false)
+    , m_txnTxDoneUs(0)
+    , m_nextPollDeadlineUs(0)
+    , m_bulkDeferCount(0)
+    , m_deferredBulk(nullptr)
     , m_transmitCount(0)
     , m_receiveCount(0)
     , m_errorCount(0)
+    , m_fifoOverflowCount(0)
+    , m_frameErrorCount(0)
+    , m_bufferFullCount(0)
+    , m_collisionCount(0)
+    , m_transactionTimeoutCount(0)
+    , m_unsolicitedCount(0)
+    , m_turnaroundSlotsUsed(0)
+    , m_turnaroundDropped(0)
 {
+    for (std::atomic<uint32_t>& word : m_turnaroundDroppedMask) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    for (TxLaneState& lane : m_lanes) {
+        lane.maxDepth = 0;
+    }
 }
 
 RS485Communication::~RS485Communication() {
@@ -28,42 +49,29 @@ bool RS485Communication::initialize() {
         return true;
     }
 
-    // Create FreeRTOS objects
-    m_rxQueue = xQueueCreate(CrestronProtocol::MESSAGE_QUEUE_SIZE, sizeof(Message));
-    m_txQueue = xQueueCreate(CrestronProtocol::MESSAGE_QUEUE_SIZE, sizeof(Message));
-    m_txMutex = xSemaphoreCreateMutex();
-
-    if (!m_rxQueue || !m_txQueue || !m_txMutex) {
-        ESP_LOGE(TAG, "Failed to create FreeRTOS objects");
+    // Open the bus (UART on the target, a pseudo-terminal natively)
+    if (!m_transport.open(m_settings)) {
+        ESP_LOGE(TAG, "Failed to open %s transport", m_settings.name);
         deinitialize();
         return false;
     }
 
-    // Configure UART
-    if (!configureUART()) {
-        ESP_LOGE(TAG, "Failed to configure UART");
-        deinitialize();
-        return false;
-    }
-
-    // Configure DE/RE pin for RS485 transceiver
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << RS485Config::DE_RE_PIN),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+    // One-shot timer that wakes a transaction at its reply deadline. esp_timer
+    // has no static variant; this is the one allocation the bus makes, at init
+    esp_timer_create_args_t timerArgs = {
+        .callback = deadlineTimerCallback,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "RS485Deadline",
+        .skip_unhandled_events = false
     };
-    
-    if (gpio_config(&io_conf) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure DE/RE pin");
+
+    if (esp_timer_create(&timerArgs, &m_deadlineTimer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create deadline timer");
         deinitialize();
         return false;
     }
 
-    // Set to receive mode initially
-    setTransmitMode(false);
-
     // Start communication tasks
     startTasks();
 
@@ -77,64 +85,31 @@ void RS485Communication::deinitialize() {
 
     stopTasks();
 
-    if (m_rxQueue) {
-        vQueueDelete(m_rxQueue);
-        m_rxQueue = nullptr;
-    }
-    
-    if (m_txQueue) {
-        vQueueDelete(m_txQueue);
-        m_txQueue = nullptr;
-    }
-    
-    if (m_txMutex) {
-        vSemaphoreDelete(m_txMutex);
-        m_txMutex = nullptr;
+    if (m_deadlineTimer) {
+        esp_timer_stop(m_deadlineTimer);
+        esp_timer_delete(m_deadlineTimer);
+        m_deadlineTimer = nullptr;
     }
 
-    uart_driver_delete(UART_PORT);
+    m_transport.close();
     m_initialized = false;
     
     ESP_LOGI(TAG, "RS485 communication deinitialized");
 }
 
-bool RS485Communication::configureUART() {
-    uart_config_t uart_config = {
-        .baud_rate = static_cast<int>(RS485Config::BAUD_RATE),
-        .data_bits = RS485Config::DATA_BITS,
-        .parity = RS485Config::PARITY,
-        .stop_bits = RS485Config::STOP_BITS,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .rx_flow_ctrl_thresh = 0,
-        .source_clk = UART_SCLK_APB
-    };
-
-    if (uart_param_config(UART_PORT, &uart_config) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure UART parameters");
-        return false;
-    }
-
-    if (uart_set_pin(UART_PORT, RS485Config::TX_PIN, RS485Config::RX_PIN, 
-                     UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set UART pins");
-        return false;
-    }
-
-    if (uart_driver_install(UART_PORT, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 
-                           0, nullptr, 0) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to install UART driver");
-        return false;
-    }
-
-    return true;
-}
-
 void RS485Communication::startTasks() {
-    xTaskCreate(rxTaskFunction, "RS485_RX", StackSizes::RS485_HANDLER, 
-                this, TaskPriorities::RS485_HANDLER, &m_rxTaskHandle);
-                
-    xTaskCreate(txTaskFunction, "RS485_TX", StackSizes::RS485_HANDLER, 
-                this, TaskPriorities::RS485_HANDLER, &m_txTaskHandle);
+    // Each bus keeps its tasks on its own core so two segments run in parallel
+    char name[configMAX_TASK_NAME_LEN];
+    
+    snprintf(name, sizeof(name), "RS485_RX_%s", m_settings.name);
+    m_rxTaskHandle = xTaskCreateStaticPinnedToCore(rxTaskFunction, name, StackSizes::RS485_HANDLER,
+                                                   this, TaskPriorities::RS485_HANDLER, m_rxTaskStack,
+                                                   &m_rxTaskBuffer, m_settings.core);
+    
+    snprintf(name, sizeof(name), "RS485_TX_%s", m_settings.name);
+    m_txTaskHandle = xTaskCreateStaticPinnedToCore(txTaskFunction, name, StackSizes::RS485_HANDLER,
+                                                   this, TaskPriorities::RS485_HANDLER, m_txTaskStack,
+                                                   &m_txTaskBuffer, m_settings.core);
 }
 
 void RS485Communication::stopTasks() {
@@ -149,78 +124,236 @@ void RS485Communication::stopTasks() {
     }
 }
 
-bool RS485Communication::sendMessage(const uint8_t* data, size_t length) {
-    if (!m_initialized || !data || length == 0 || length > CrestronProtocol::MAX_MESSAGE_LENGTH) {
-        return false;
+RS485Communication::Message* RS485Communication::acquireTxMessage() {
+    if (!m_initialized) return nullptr;
+    
+    Message* message = m_txPool.acquire();
+    if (!message) {
+        m_errorCount++;
+        ESP_LOGW(TAG, "TX frame pool exhausted");
+        return nullptr;
     }
+    
+    message->breakBits = 0;
+    message->awaitTxDone = false;
+    message->txTag = 0;
+    return message;
+}
 
-    Message message;
-    memcpy(message.data, data, length);
-    message.length = length;
-    message.timestamp = xTaskGetTickCount();
-    message.isIncoming = false;
+bool RS485Communication::submitTxMessage(Message* message, TxLane lane) {
+    if (!message || lane >= TxLane::COUNT) return false;
+    
+    bool valid = message->length > 0 && message->length <= CrestronProtocol::MAX_MESSAGE_LENGTH;
+    if (!valid) {
+        // Give it back through the TX task so the pool keeps a single releaser
+        message->length = 0;
+    }
+    
+    message->timestampUs = esp_timer_get_time();
+    message->isIncoming = false;
+    
+    // Cannot overflow: each lane holds as many handles as the pool has frames
+    TxLaneState& state = m_lanes[laneIndex(lane)];
+    state.ring.push(message);
+    
+    uint32_t depth = state.ring.size();
+    if (depth > state.maxDepth) {
+        state.maxDepth = depth;
+    }
+    
+    xTaskNotifyGive(m_txTaskHandle);
+    return valid;
+}
 
-    if (xSemaphoreTake(m_txMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        bool result = xQueueSend(m_txQueue, &message, pdMS_TO_TICKS(50)) == pdTRUE;
-        xSemaphoreGive(m_txMutex);
-        return result;
+bool RS485Communication::sendMessage(const uint8_t* data, size_t length, TxLane lane) {
+    if (!data || length == 0 || length > CrestronProtocol::MAX_MESSAGE_LENGTH) {
+        return false;
     }
+
+    Message* message = acquireTxMessage();
+    if (!message) return false;
     
-    return false;
+    memcpy(message->data, data, length);
+    message->length = length;
+    return submitTxMessage(message, lane);
 }
 
 bool RS485Communication::sendPing(uint8_t slaveAddress) {
-    uint8_t pingData[2] = {slaveAddress, CrestronProtocol::PING_COMMAND};
-    return sendMessage(pingData, sizeof(pingData));
+    Message* message = acquireTxMessage();
+    if (!message) return false;
+    
+    message->data[0] = slaveAddress;
+    message->data[1] = CrestronProtocol::PING_COMMAND;
+    message->length = 2;
+    return submitTxMessage(message, TxLane::POLL);
 }
 
-bool RS485Communication::sendBreak() {
-    // Send a break signal by pulling TX low for precise timing
-    setTransmitMode(true);
+bool RS485Communication::sendBreak(uint32_t durationUs) {
+    // DE/RE is owned by the UART, so the break comes from the peripheral as
+    // well: a NUL byte (ignored by idle slaves) followed by a line break,
+    // queued behind any frames already waiting
+    uint32_t breakBits = (static_cast<uint64_t>(durationUs) * m_settings.baudRate + 999999UL) / 1000000UL;
+    if (breakBits == 0) breakBits = 1;
+    if (breakBits > 255) breakBits = 255;
     
-    // Critical section for precise timing
-    noInterrupts();
-    gpio_set_level(static_cast<gpio_num_t>(RS485Config::TX_PIN), 0);
-    criticalSectionDelay(CrestronTiming::BREAK_DURATION_US);
-    gpio_set_level(static_cast<gpio_num_t>(RS485Config::TX_PIN), 1);
-    interrupts();
+    Message* message = acquireTxMessage();
+    if (!message) return false;
     
-    vTaskDelay(pdMS_TO_TICKS(1)); // Brief recovery time
-    setTransmitMode(false);
+    message->data[0] = 0x00;
+    message->length = 1;
+    message->breakBits = static_cast<uint8_t>(breakBits);
+    return submitTxMessage(message);
+}
+
+RS485Communication::TransactionResult RS485Communication::transact(Message* request, uint32_t replyTimeoutUs) {
+    TransactionResult result = {TransactionStatus::SEND_FAILED, nullptr, 0, 0};
+    if (!request) return result;
     
-    return true;
+    // The TX task releases the request once sent, so keep what we need of it
+    const uint8_t address = request->data[0];
+    
+    m_txnOwner = xTaskGetCurrentTaskHandle();
+    m_txnTxDone.store(false, std::memory_order_relaxed);
+    m_txnCollision = false;
+    request->awaitTxDone = true;
+    
+    if (!submitTxMessage(request, TxLane::POLL) || !waitForTxDone()) {
+        releaseBus();
+        return result;
+    }
+    
+    result.txDoneUs = m_txnTxDoneUs;
+    
+    if (m_txnCollision) {
+        m_collisionCount++;
+        releaseBus();
+        result.status = TransactionStatus::COLLISION;
+        return result;
+    }
+    
+    // The half-duplex UART discards its own echo, so anything delimited
+    // after txDone and before the deadline is the reply
+    const int64_t deadlineUs = result.txDoneUs + replyTimeoutUs;
+    const uint32_t charTimeUs = m_transport.characterTimeUs();
+    
+    m_rxWaiter = m_txnOwner;
+    int64_t remainingUs = deadlineUs - esp_timer_get_time();
+    if (remainingUs > 0) {
+        esp_timer_start_once(m_deadlineTimer, static_cast<uint64_t>(remainingUs));
+    }
+    
+    result.status = TransactionStatus::TIMEOUT;
+    while (true) {
+        Message* frame = nullptr;
+        if (m_rxRing.peek(frame)) {
+            if (frame->timestampUs < result.txDoneUs) {
+                // Delimited before our request went out; nobody is waiting for it
+                m_rxRing.pop(frame);
+                m_rxPool.release(frame);
+                m_unsolicitedCount++;
+                continue;
+            }
+            
+            if (frame->timestampUs <= deadlineUs) {
+                m_rxRing.pop(frame);
+                result.status = TransactionStatus::REPLY;
+                result.reply = frame;
+                
+                // Frame is stamped once the idle gap after its last byte elapsed
+                int64_t frameUs = static_cast<int64_t>(frame->length + m_settings.rxIdleTimeoutSymbols) * charTimeUs;
+                int64_t turnaroundUs = frame->timestampUs - frameUs - result.txDoneUs;
+                result.turnaroundUs = turnaroundUs > 0 ? static_cast<uint32_t>(turnaroundUs) : 0;
+                recordTurnaround(address, result.turnaroundUs);
+            }
+            // A frame past the deadline stays queued for the normal receive path
+            break;
+        }
+        
+        remainingUs = deadlineUs - esp_timer_get_time();
+        if (remainingUs <= 0) {
+            break;
+        }
+        
+        // Woken by the RX task or the deadline timer; the tick timeout is only a backstop
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(remainingUs / 1000) + 2);
+    }
+    
+    esp_timer_stop(m_deadlineTimer);
+    m_rxWaiter = nullptr;
+    releaseBus();
+    
+    if (result.status == TransactionStatus::TIMEOUT) {
+        m_transactionTimeoutCount++;
+    }
+    
+    return result;
 }
 
-bool RS485Communication::receiveMessage(Message& message, TickType_t timeout) {
-    if (!m_initialized) return false;
+void RS485Communication::releaseBus() {
+    m_txnOwner = nullptr;
     
-    return xQueueReceive(m_rxQueue, &message, timeout) == pdTRUE;
+    // Frames queued behind the transaction were held until now
+    xTaskNotifyGive(m_txTaskHandle);
 }
 
-size_t RS485Communication::getAvailableMessages() const {
-    return m_rxQueue ? uxQueueMessagesWaiting(m_rxQueue) : 0;
+bool RS485Communication::waitForTxDone() {
+    const TickType_t start = xTaskGetTickCount();
+    const TickType_t limit = pdMS_TO_TICKS(TX_DONE_TIMEOUT_MS);
+    
+    while (!m_txnTxDone.load(std::memory_order_acquire)) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= limit) {
+            ESP_LOGW(TAG, "Transaction request never finished transmitting");
+            return false;
+        }
+        ulTaskNotifyTake(pdTRUE, limit - elapsed);
+    }
+    
+    return true;
 }
 
-void RS485Communication::setTransmitMode(bool enable) {
-    gpio_set_level(static_cast<gpio_num_t>(RS485Config::DE_RE_PIN), enable ? 1 : 0);
+void RS485Communication::deadlineTimerCallback(void* parameter) {
+    RS485Communication* instance = static_cast<RS485Communication*>(parameter);
+    TaskHandle_t owner = instance->m_txnOwner;
+    if (owner) {
+        xTaskNotifyGive(owner);
+    }
+}
+
+RS485Communication::Message* RS485Communication::receiveMessage(TickType_t timeout) {
+    if (!m_initialized) return nullptr;
+    
+    Message* message = nullptr;
+    if (m_rxRing.pop(message) || timeout == 0) {
+        return message;
+    }
     
-    // Small delay to allow transceiver to switch modes
-    if (enable) {
-        delayMicroseconds(10); // TX enable delay
-    } else {
-        delayMicroseconds(5);  // RX enable delay
+    // Register before re-checking so a frame pushed in between still wakes us
+    m_rxWaiter = xTaskGetCurrentTaskHandle();
+    if (!m_rxRing.pop(message)) {
+        ulTaskNotifyTake(pdTRUE, timeout);
+        m_rxRing.pop(message);
     }
+    m_rxWaiter = nullptr;
+    
+    return message;
+}
+
+void RS485Communication::releaseMessage(Message* message) {
+    m_rxPool.release(message);
+}
+
+size_t RS485Communication::getAvailableMessages() const {
+    return m_rxRing.size();
 }
 
 void RS485Communication::flushBuffers() {
-    uart_flush(UART_PORT);
+    // Consumer side only: drop pending RX frames; queued TX frames still go out
+    m_transport.flushInput();
     
-    // Clear our queues
-    if (m_rxQueue) {
-        xQueueReset(m_rxQueue);
-    }
-    if (m_txQueue) {
-        xQueueReset(m_txQueue);
+    Message* message = nullptr;
+    while (m_rxRing.pop(message)) {
+        m_rxPool.release(message);
     }
 }
 
@@ -236,64 +369,322 @@ void RS485Communication::txTaskFunction(void* parameter) {
 }
 
 void RS485Communication::handleReceive() {
-    Message message;
-    uint8_t buffer[CrestronProtocol::MAX_MESSAGE_LENGTH];
+    Message* message = nullptr;
+    BusTransport::Event event;
+    bool discarding = false;
+    int64_t lastFrameUs = 0;
     
     while (true) {
-        int length = uart_read_bytes(UART_PORT, buffer, sizeof(buffer), pdMS_TO_TICKS(100));
+        if (!m_transport.waitEvent(event, portMAX_DELAY)) {
+            continue;
+        }
         
-        if (length > 0) {
-            message.length = length;
-            memcpy(message.data, buffer, length);
-            message.timestamp = xTaskGetTickCount();
-            message.isIncoming = true;
+        switch (event.type) {
+            case BusTransport::EventType::DATA: {
+                // Frames are assembled directly in a pool buffer
+                if (!message && !discarding) {
+                    message = m_rxPool.acquire();
+                    if (message) {
+                        message->length = 0;
+                    } else {
+                        m_errorCount++;
+                        ESP_LOGW(TAG, "RX frame pool exhausted, dropping frame");
+                        discarding = true;
+                    }
+                }
+                
+                // Append to the frame under construction; a frame that outgrows
+                // the buffer is dropped as a whole rather than split in two
+                if (!discarding && event.size <= sizeof(message->data) - message->length) {
+                    m_transport.read(message->data + message->length, event.size);
+                    message->length += event.size;
+                } else {
+                    if (!discarding) {
+                        m_errorCount++;
+                        ESP_LOGW(TAG, "Frame exceeds %d bytes, dropping", static_cast<int>(sizeof(message->data)));
+                    }
+                    m_transport.flushInput();
+                    discarding = true;
+                }
+                
+                // frameEnd is set once the line has been idle, i.e. the
+                // frame is complete
+                if (!event.frameEnd) {
+                    break;
+                }
+                
+                if (!discarding && message->length > 0) {
+                    message->timestampUs = esp_timer_get_time();
+                    message->isIncoming = true;
+                    
+                    if (lastFrameUs != 0) {
+                        m_interArrival.record(message->timestampUs - lastFrameUs);
+                    }
+                    lastFrameUs = message->timestampUs;
+                    m_capture.record(BusCapture::FLAG_RX, message->timestampUs, message->data, message->length);
+                    
+                    // Cannot overflow: the ring holds as many handles as the pool has frames
+                    m_rxRing.push(message);
+                    message = nullptr;
+                    m_receiveCount++;
+                    
+                    TaskHandle_t waiter = m_rxWaiter;
+                    if (waiter) {
+                        xTaskNotifyGive(waiter);
+                    }
+                } else if (message) {
+                    message->length = 0;
+                }
+                
+                discarding = false;
+                break;
+            }
             
-            if (xQueueSend(m_rxQueue, &message, 0) == pdTRUE) {
-                m_receiveCount++;
-            } else {
+            case BusTransport::EventType::FIFO_OVERFLOW:
+                m_fifoOverflowCount++;
+                ESP_LOGW(TAG, "UART FIFO overflow");
+                discardReceivedData();
+                if (message) message->length = 0;
+                discarding = false;
+                break;
+                
+            case BusTransport::EventType::BUFFER_FULL:
+                m_bufferFullCount++;
+                ESP_LOGW(TAG, "UART ring buffer full");
+                discardReceivedData();
+                if (message) message->length = 0;
+                discarding = false;
+                break;
+                
+            case BusTransport::EventType::FRAME_ERROR:
+                // Corrupt byte; drop the rest of this frame at the next idle
+                // gap. A glitch between frames has no frame to spoil, and
+                // must not cost the next one.
+                m_frameErrorCount++;
+                discarding = discarding || (message && message->length > 0);
+                break;
+                
+            case BusTransport::EventType::PARITY_ERROR:
                 m_errorCount++;
-                ESP_LOGW(TAG, "RX queue full, dropping message");
-            }
+                discarding = discarding || (message && message->length > 0);
+                break;
+                
+            default:
+                break;
         }
     }
 }
 
+void RS485Communication::discardReceivedData() {
+    // After an overflow the ring buffer and pending events no longer line up
+    m_transport.discardInput();
+}
+
 void RS485Communication::handleTransmit() {
-    Message message;
+    Message* message = nullptr;
     
     while (true) {
-        if (xQueueReceive(m_txQueue, &message, portMAX_DELAY) == pdTRUE) {
-            setTransmitMode(true);
-            
-            int bytesWritten = uart_write_bytes(UART_PORT, message.data, message.length);
-            
-            // Wait for transmission to complete
-            uart_wait_tx_done(UART_PORT, pdMS_TO_TICKS(100));
-            
-            setTransmitMode(false);
+        TickType_t waitTicks = portMAX_DELAY;
+        message = nextTxMessage(waitTicks);
+        if (!message) {
+            ulTaskNotifyTake(pdTRUE, waitTicks);
+            continue;
+        }
+        
+        if (message->length > 0) {
+            // Hands the frame to the UART and returns; DE drops in hardware
+            // after the last stop bit (or after the break, if one is requested)
+            int bytesWritten = message->breakBits > 0
+                ? m_transport.writeWithBreak(message->data, message->length, message->breakBits)
+                : m_transport.write(message->data, message->length);
+            int64_t wireUs = esp_timer_get_time();
+            m_enqueueToWire.record(wireUs - message->timestampUs);
+            m_capture.record(message->breakBits > 0 ? BusCapture::FLAG_BREAK : 0,
+                             wireUs, message->data, message->length);
             
-            if (bytesWritten == message.length) {
+            if (bytesWritten == static_cast<int>(message->length)) {
                 m_transmitCount++;
             } else {
                 m_errorCount++;
                 ESP_LOGW(TAG, "Failed to transmit complete message");
             }
+            
+            // One frame in the UART at a time: until it has left, later frames
+            // stay in their lanes where polls can overtake them and queued
+            // dimmer levels can still be merged. Blocks on the driver's
+            // TX-done interrupt, not a busy wait.
+            bool done = m_transport.waitTxDone(pdMS_TO_TICKS(TX_DONE_TIMEOUT_MS));
+            
+            if (message->txTag != 0) {
+                const uint16_t tag = message->txTag;
+                const int64_t doneUs = esp_timer_get_time();
+                m_taggedTx.write([tag, wireUs, doneUs](TaggedTxStats& stats) {
+                    if (stats.tag != tag) {
+                        stats = {tag, 0, wireUs, 0};
+                    }
+                    stats.frames++;
+                    stats.lastDoneUs = doneUs;
+                });
+            }
+            
+            if (message->awaitTxDone) {
+                m_txnTxDoneUs = esp_timer_get_time();
+                m_txnCollision = m_transport.collisionDetected();
+                
+                TaskHandle_t owner = m_txnOwner;
+                if (done && owner) {
+                    m_txnTxDone.store(true, std::memory_order_release);
+                    xTaskNotifyGive(owner);
+                }
+            }
+        }
+        
+        m_txPool.release(message);
+    }
+}
+
+RS485Communication::Message* RS485Communication::nextTxMessage(TickType_t& waitTicks) {
+    Message* message = nullptr;
+    TxLaneState& poll = m_lanes[laneIndex(TxLane::POLL)];
+    TxLaneState& control = m_lanes[laneIndex(TxLane::CONTROL)];
+    TxLaneState& bulk = m_lanes[laneIndex(TxLane::BULK)];
+    const int64_t now = esp_timer_get_time();
+    
+    if (poll.ring.pop(message)) {
+        poll.queueWait.record(now - message->timestampUs);
+        return message;
+    }
+    
+    // The bus belongs to the slave until the pending transaction finishes;
+    // releaseBus() wakes us again
+    if (m_txnOwner) {
+        return nullptr;
+    }
+    
+    // Control frames go first, except that a bulk frame which has waited
+    // BULK_MAX_WAIT_US takes the next gap, so a steady stream of dimmer
+    // levels cannot hold up configuration indefinitely
+    Message* bulkHead = nullptr;
+    const bool bulkOverdue = bulk.ring.peek(bulkHead) &&
+        now - bulkHead->timestampUs > static_cast<int64_t>(CrestronTiming::BULK_MAX_WAIT_US);
+    
+    if (!bulkOverdue && control.ring.pop(message)) {
+        control.queueWait.record(now - message->timestampUs);
+        return message;
+    }
+    
+    if (!bulkHead) {
+        return nullptr;
+    }
+    message = bulkHead;
+    
+    // Hold a bulk frame that would still be on the wire when the next poll is
+    // due. Once the deadline has passed by more than the grace period the poll
+    // is not coming (pinging disabled), so bulk traffic is released.
+    const int64_t deadline = m_nextPollDeadlineUs.load(std::memory_order_relaxed);
+    const int64_t airtimeUs = static_cast<int64_t>(message->length) * m_transport.characterTimeUs() +
+                              (static_cast<int64_t>(message->breakBits) * 1000000LL) / m_settings.baudRate;
+    
+    if (deadline != 0 && now + airtimeUs > deadline &&
+        now < deadline + static_cast<int64_t>(CrestronTiming::POLL_GRACE_US)) {
+        int64_t holdUs = deadline + CrestronTiming::POLL_GRACE_US - now;
+        waitTicks = pdMS_TO_TICKS(holdUs / 1000) + 1;
+        if (message != m_deferredBulk) {
+            m_deferredBulk = message;
+            m_bulkDeferCount++;
         }
+        
+        // An overdue frame that must still wait for the poll does not idle
+        // the bus; control traffic uses the gap instead
+        if (bulkOverdue && control.ring.pop(message)) {
+            control.queueWait.record(now - message->timestampUs);
+            return message;
+        }
+        return nullptr;
     }
+    
+    bulk.ring.pop(message);
+    bulk.queueWait.record(now - message->timestampUs);
+    return message;
 }
 
-void RS485Communication::preciseDelay(uint32_t microseconds) {
-    if (microseconds < 1000) {
-        delayMicroseconds(microseconds);
-    } else {
-        vTaskDelay(pdMS_TO_TICKS(microseconds / 1000));
+void RS485Communication::recordTurnaround(uint8_t address, uint32_t turnaroundUs) {
+    m_turnaroundAll.record(turnaroundUs);
+    
+    // Only the transaction caller adds slots, so a plain scan-then-publish is enough
+    size_t used = m_turnaroundSlotsUsed.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < used; i++) {
+        if (m_turnaroundSlots[i].address == address) {
+            m_turnaroundSlots[i].histogram.record(turnaroundUs);
+            return;
+        }
     }
+    
+    if (used < TURNAROUND_SLOTS) {
+        m_turnaroundSlots[used].address = address;
+        m_turnaroundSlots[used].histogram.record(turnaroundUs);
+        m_turnaroundSlotsUsed.store(used + 1, std::memory_order_release);
+        return;
+    }
+    
+    // Logged once per address
+    m_turnaroundDropped.fetch_add(1, std::memory_order_relaxed);
+    uint32_t bit = 1UL << (address % 32);
+    uint32_t previous = m_turnaroundDroppedMask[address / 32].fetch_or(bit, std::memory_order_relaxed);
+    if (!(previous & bit)) {
+        ESP_LOGW(TAG, "No turnaround histogram left for slave 0x%02X (%u in use)",
+                 address, static_cast<unsigned>(TURNAROUND_SLOTS));
+    }
+}
+
+size_t RS485Communication::getTurnaroundDroppedAddresses() const {
+    size_t count = 0;
+    for (const std::atomic<uint32_t>& word : m_turnaroundDroppedMask) {
+        count += __builtin_popcount(word.load(std::memory_order_relaxed));
+    }
+    return count;
+}
+
+const LatencyHistogram* RS485Communication::getTurnaroundHistogram(size_t slot, uint8_t& address) const {
+    if (slot >= m_turnaroundSlotsUsed.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    
+    address = m_turnaroundSlots[slot].address;
+    return &m_turnaroundSlots[slot].histogram;
+}
+
+RS485Communication::TaggedTxStats RS485Communication::getTaggedTxStats() const {
+    TaggedTxStats stats;
+    m_taggedTx.read([&stats](const TaggedTxStats& current) { stats = current; });
+    return stats;
 }
 
-void RS485Communication::criticalSectionDelay(uint32_t microseconds) {
-    // Use ESP32 high-resolution timer for critical timing
-    uint64_t start = esp_timer_get_time();
-    while ((esp_timer_get_time() - start) < microseconds) {
-        // Busy wait for precise timing
+bool RS485Communication::enableCapture(bool enable) {
+    if (enable && !m_capture.begin(RS485Config::CAPTURE_PSRAM_BYTES, RS485Config::CAPTURE_INTERNAL_BYTES)) {
+        return false;
+    }
+    
+    m_capture.setEnabled(enable);
+    return true;
+}
+
+void RS485Communication::resetHistograms() {
+    m_turnaroundAll.reset();
+    m_interArrival.reset();
+    for (TxLaneState& lane : m_lanes) {
+        lane.queueWait.reset();
+        lane.maxDepth = 0;
+    }
+    m_enqueueToWire.reset();
+    
+    // Slots keep their address so a concurrent recordTurnaround() stays valid
+    size_t used = m_turnaroundSlotsUsed.load(std::memory_order_acquire);
+    for (size_t i = 0; i < used; i++) {
+        m_turnaroundSlots[i].histogram.reset();
     }
-}
\ No newline at end of file
+    m_turnaroundDropped.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint32_t>& word : m_turnaroundDroppedMask) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
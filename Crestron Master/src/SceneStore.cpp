@@ -0,0 +1,182 @@
+#include "SceneStore.h"
+#include <Preferences.h>
+#include <esp_log.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* TAG = "SceneStore";
+
+SceneStore::SceneStore()
+    : m_count(0)
+    , m_mutex(nullptr)
+{
+}
+
+bool SceneStore::begin() {
+    if (!m_mutex) {
+        m_mutex = xSemaphoreCreateMutexStatic(&m_mutexBuffer);
+        if (!m_mutex) {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return false;
+        }
+    }
+
+    Preferences preferences;
+    if (!preferences.begin(SceneConfig::NVS_NAMESPACE, true)) {
+        // Nothing stored yet; the namespace appears with the first save
+        m_count = 0;
+        return true;
+    }
+
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    size_t count = 0;
+    for (uint8_t slot = 0; slot < SceneConfig::MAX_SCENES; slot++) {
+        char key[8];
+        keyFor(slot, key, sizeof(key));
+        if (!preferences.isKey(key)) continue;
+
+        // Reject blobs from another layout rather than recall garbage
+        Scene& scene = m_scenes[count];
+        size_t length = preferences.getBytes(key, &scene, sizeof(Scene));
+        if (length < blobSize(0) || scene.count > SceneConfig::MAX_TARGETS ||
+            length != blobSize(scene.count)) {
+            ESP_LOGW(TAG, "Ignoring malformed scene in %s (%u bytes)", key, static_cast<unsigned>(length));
+            continue;
+        }
+
+        scene.name[SceneConfig::NAME_LENGTH - 1] = '\0';
+        m_slots[count] = slot;
+        count++;
+    }
+    m_count = count;
+    xSemaphoreGive(m_mutex);
+
+    preferences.end();
+    ESP_LOGI(TAG, "Loaded %u scenes", static_cast<unsigned>(count));
+    return true;
+}
+
+bool SceneStore::save(const Scene& scene) {
+    if (!m_mutex || scene.count > SceneConfig::MAX_TARGETS || scene.name[0] == '\0') {
+        return false;
+    }
+
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    size_t index = findLocked(scene.name);
+    if (index == m_count) {
+        if (m_count == SceneConfig::MAX_SCENES) {
+            xSemaphoreGive(m_mutex);
+            ESP_LOGW(TAG, "Scene table full");
+            return false;
+        }
+
+        uint8_t slot = 0;
+        while (slotInUseLocked(slot)) {
+            slot++;
+        }
+        m_slots[index] = slot;
+    }
+
+    Scene& stored = m_scenes[index];
+    memcpy(&stored, &scene, blobSize(scene.count));
+    stored.name[SceneConfig::NAME_LENGTH - 1] = '\0';
+
+    char key[8];
+    keyFor(m_slots[index], key, sizeof(key));
+
+    Preferences preferences;
+    bool written = preferences.begin(SceneConfig::NVS_NAMESPACE, false) &&
+                   preferences.putBytes(key, &stored, blobSize(stored.count)) == blobSize(stored.count);
+    preferences.end();
+
+    // Kept in RAM even if the write failed; it is lost on the next boot
+    if (index == m_count) {
+        m_count = index + 1;
+    }
+    xSemaphoreGive(m_mutex);
+
+    if (!written) {
+        ESP_LOGE(TAG, "Failed to store scene \"%s\"", scene.name);
+    }
+    return written;
+}
+
+bool SceneStore::remove(const char* name) {
+    if (!m_mutex) return false;
+
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    size_t index = findLocked(name);
+    if (index == m_count) {
+        xSemaphoreGive(m_mutex);
+        return false;
+    }
+
+    char key[8];
+    keyFor(m_slots[index], key, sizeof(key));
+
+    for (size_t i = index + 1; i < m_count; i++) {
+        memcpy(&m_scenes[i - 1], &m_scenes[i], blobSize(m_scenes[i].count));
+        m_slots[i - 1] = m_slots[i];
+    }
+    m_count = m_count - 1;
+
+    Preferences preferences;
+    if (preferences.begin(SceneConfig::NVS_NAMESPACE, false)) {
+        preferences.remove(key);
+    }
+    preferences.end();
+    xSemaphoreGive(m_mutex);
+    return true;
+}
+
+bool SceneStore::get(const char* name, Scene& scene) const {
+    if (!m_mutex) return false;
+
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    size_t index = findLocked(name);
+    bool found = index < m_count;
+    if (found) {
+        memcpy(&scene, &m_scenes[index], blobSize(m_scenes[index].count));
+    }
+    xSemaphoreGive(m_mutex);
+    return found;
+}
+
+bool SceneStore::nameAt(size_t index, char* name, size_t length) const {
+    if (!m_mutex || length == 0) return false;
+
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    bool found = index < m_count;
+    if (found) {
+        strncpy(name, m_scenes[index].name, length - 1);
+        name[length - 1] = '\0';
+    }
+    xSemaphoreGive(m_mutex);
+    return found;
+}
+
+size_t SceneStore::findLocked(const char* name) const {
+    for (size_t i = 0; i < m_count; i++) {
+        if (strncmp(m_scenes[i].name, name, SceneConfig::NAME_LENGTH) == 0) {
+            return i;
+        }
+    }
+    return m_count;
+}
+
+bool SceneStore::slotInUseLocked(uint8_t slot) const {
+    for (size_t i = 0; i < m_count; i++) {
+        if (m_slots[i] == slot) return true;
+    }
+    return false;
+}
+
+void SceneStore::keyFor(uint8_t slot, char* key, size_t length) {
+    snprintf(key, length, "s%u", static_cast<unsigned>(slot));
+}
+
+size_t SceneStore::blobSize(uint8_t count) {
+    // Only the targets in use are stored
+    return offsetof(Scene, targets) + count * sizeof(Target);
+}
@@ -1,22 +1,67 @@
 #include "SlaveManager.h"
 #include <esp_log.h>
+#include <string.h>
 #include <algorithm>
 
 static const char* TAG = "SlaveManager";
 
 SlaveManager::SlaveManager(RS485Communication& rs485)
     : m_rs485(rs485)
+    , m_maxLevelsPerFrame(CrestronProtocol::DEFAULT_LEVELS_PER_FRAME)
     , m_taskHandle(nullptr)
-    , m_pingTimer(nullptr)
-    , m_commandQueue(nullptr)
+    , m_slotTimer(nullptr)
+    , m_slotQueue(nullptr)
     , m_slavesMutex(nullptr)
+    , m_transaction{false, 0, ReplyKind::PING, 0, 0}
     , m_initialized(false)
     , m_pingEnabled(false)
-    , m_currentSlaveIndex(0)
     , m_pingSequenceNumber(0)
     , m_totalPings(0)
     , m_successfulPings(0)
     , m_configurationCount(0)
+    , m_lateReplyCount(0)
+    , m_unmatchedReplyCount(0)
+    , m_levelFrameCount(0)
+    , m_probationCount(0)
+    , m_configCursor(0)
+    , m_priorityCursor(0)
+    , m_lastPollPrioritised(false)
+    , m_discoveryEnabled(false)
+    , m_discoveryCursor(DiscoveryConfig::FIRST_ADDRESS)
+    , m_cyclesSinceProbe(0)
+    , m_sweepStartTime(0)
+    , m_sweepProbes(0)
+    , m_probeCount(0)
+    , m_discoveredCount(0)
+    , m_sweepCount(0)
+    , m_lastSweepMs(0)
+    , m_estimatedSweepMs(0)
+    , m_recall{}
+    , m_recallTag(0)
+    , m_nextRecallTag(0)
+    , m_subscriberCount(0)
+    , m_eventCounts{}
+    , m_deliveries{}
+    , m_finishedDeliveries{}
+    , m_controlFrames(0)
+    , m_pollWireSeq(0)
+    , m_deliveryOutcomes{}
+    , m_resendCount(0)
+    , m_slotLengthUs{}
+    , m_cycleUs(0)
+    , m_characterUs(0)
+    , m_slotsRunning(false)
+    , m_nextSlot{}
+    , m_nextPollSlotUs(0)
+    , m_wireIdleUs(0)
+    , m_idleSlots(0)
+    , m_cycleStartUs(0)
+    , m_slotCount(0)
+    , m_skippedSlots(0)
+    , m_endedSlots(0)
+    , m_slotOverruns(0)
+    , m_breakCount(0)
+    , m_slotUses{}
 {
 }
 
@@ -30,42 +75,59 @@ bool SlaveManager::initialize() {
         return true;
     }
 
-    // Create FreeRTOS objects
-    m_commandQueue = xQueueCreate(16, sizeof(Command));
-    m_slavesMutex = xSemaphoreCreateMutex();
+    // Create FreeRTOS objects in the member buffers
+    m_slotQueue = xQueueCreateStatic(SLOT_QUEUE_LENGTH, sizeof(SlotStart),
+                                     m_slotQueueStorage, &m_slotQueueBuffer);
+    m_slavesMutex = xSemaphoreCreateMutexStatic(&m_slavesMutexBuffer);
     
-    if (!m_commandQueue || !m_slavesMutex) {
+    if (!m_slotQueue || !m_slavesMutex) {
         ESP_LOGE(TAG, "Failed to create FreeRTOS objects");
         deinitialize();
         return false;
     }
 
-    // Initialize configuration templates
-    initializeConfigTemplates();
-
-    // Create ping timer (but don't start it yet)
-    m_pingTimer = xTimerCreate("PingTimer", 
-                               pdMS_TO_TICKS(CrestronTiming::PING_INTERVAL_MS),
-                               pdTRUE, // Auto-reload
-                               this,   // Timer ID
-                               pingTimerCallback);
-
-    if (!m_pingTimer) {
-        ESP_LOGE(TAG, "Failed to create ping timer");
+    // Slot timer; a hardware-backed one-shot, armed by the bus task for every slot
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = slotTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "bus_slot";
+    if (esp_timer_create(&timerArgs, &m_slotTimer) != ESP_OK) {
+        m_slotTimer = nullptr;
+        ESP_LOGE(TAG, "Failed to create slot timer");
         deinitialize();
         return false;
     }
 
+    m_characterUs = BusSchedule::characterUs(m_rs485.getSettings().baudRate);
+    m_cycleUs = 0;
+    for (size_t i = 0; i < BusSchedule::SLOT_COUNT; i++) {
+        m_slotLengthUs[i] = BusSchedule::slotLengthUs(BusSchedule::SLOTS[i], m_rs485.getSettings().baudRate,
+                                                      m_rs485.getSettings().pingTimeoutUs);
+        m_cycleUs += m_slotLengthUs[i];
+    }
+
     // Create main task
-    if (xTaskCreate(taskFunction, "SlaveManager", StackSizes::SLAVE_MANAGER, 
-                    this, TaskPriorities::SLAVE_MANAGER, &m_taskHandle) != pdPASS) {
+    // Run on the same core as the bus tasks; a second bus runs on the other core
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "SlaveMgr_%s", m_rs485.getSettings().name);
+    m_taskHandle = xTaskCreateStaticPinnedToCore(taskFunction, name, StackSizes::SLAVE_MANAGER,
+                                                 this, TaskPriorities::SLAVE_MANAGER, m_taskStack,
+                                                 &m_taskBuffer, m_rs485.getSettings().core);
+    if (!m_taskHandle) {
         ESP_LOGE(TAG, "Failed to create slave manager task");
         deinitialize();
         return false;
     }
 
     m_initialized = true;
-    ESP_LOGI(TAG, "Slave manager initialized successfully");
+
+    // First slot one cycle out, once the bus task is waiting for it
+    m_slotsRunning = true;
+    armSlot(0, esp_timer_get_time() + m_cycleUs);
+
+    ESP_LOGI(TAG, "Slave manager initialized successfully (%u slots, %u us cycle)",
+             static_cast<unsigned>(BusSchedule::SLOT_COUNT), static_cast<unsigned>(m_cycleUs));
     return true;
 }
 
@@ -74,19 +136,25 @@ void SlaveManager::deinitialize() {
 
     enablePinging(false);
 
+    // Stop the slots before the task that runs them. A slot the task is
+    // running may arm the timer once more, so it is stopped again after it.
+    if (m_slotTimer) {
+        m_slotsRunning = false;
+        esp_timer_stop(m_slotTimer);
+        vTaskDelay(1);
+        esp_timer_stop(m_slotTimer);
+        esp_timer_delete(m_slotTimer);
+        m_slotTimer = nullptr;
+    }
+
     if (m_taskHandle) {
         vTaskDelete(m_taskHandle);
         m_taskHandle = nullptr;
     }
 
-    if (m_pingTimer) {
-        xTimerDelete(m_pingTimer, portMAX_DELAY);
-        m_pingTimer = nullptr;
-    }
-
-    if (m_commandQueue) {
-        vQueueDelete(m_commandQueue);
-        m_commandQueue = nullptr;
+    if (m_slotQueue) {
+        vQueueDelete(m_slotQueue);
+        m_slotQueue = nullptr;
     }
 
     if (m_slavesMutex) {
@@ -95,6 +163,11 @@ void SlaveManager::deinitialize() {
     }
 
     m_slaves.clear();
+    m_probationCount = 0;
+    for (Delivery& delivery : m_deliveries) {
+        delivery.state = DeliveryState::FREE;
+    }
+    publishSnapshot();
     m_initialized = false;
     
     ESP_LOGI(TAG, "Slave manager deinitialized");
@@ -104,19 +177,8 @@ bool SlaveManager::addSlave(uint8_t address, SlaveType type) {
     if (!m_initialized) return false;
 
     if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        SlaveInfo slave = {
-            .address = address,
-            .type = type,
-            .state = SlaveState::OFFLINE,
-            .configStep = ConfigStep::NONE,
-            .lastPingTime = 0,
-            .configStepIndex = 0,
-            .dimRequest1 = false,
-            .dimRequest2 = false,
-            .errorCount = 0
-        };
-
-        m_slaves[address] = slave;
+        m_slaves.insert(address, makeSlaveInfo(address, type));
+        publishSnapshot();
         xSemaphoreGive(m_slavesMutex);
         
         ESP_LOGI(TAG, "Added slave 0x%02X (type %d)", address, static_cast<int>(type));
@@ -126,13 +188,64 @@ bool SlaveManager::addSlave(uint8_t address, SlaveType type) {
     return false;
 }
 
+SlaveManager::SlaveInfo SlaveManager::makeSlaveInfo(uint8_t address, SlaveType type) {
+    SlaveInfo slave = {
+        .address = address,
+        .type = type,
+        .state = SlaveState::OFFLINE,
+        .lastPingTime = 0,
+        .configStepIndex = 0,
+        .configNextTime = 0,
+        .dimRequest1 = false,
+        .dimRequest2 = false,
+        .configRequested = false,
+        .errorCount = 0,
+        .lastTurnaroundUs = 0,
+        .latencyEwmaUs = 0,
+        .timeoutRatio = 0,
+        .failureStreak = 0,
+        .onProbation = false,
+        .lastSeenTime = 0,
+        .bytesSent = 0,
+        .bytesReceived = 0,
+        .probationCount = 0,
+        .nextPollTime = 0,
+        .backoffLevel = 0,
+        .pendingCommands = 0,
+        .pollCount = 0,
+        .pollIntervalMs = 0,
+        .targetLevels = {},
+        .knownLevels = 0
+    };
+    return slave;
+}
+
+bool SlaveManager::setSlaveType(uint8_t address, SlaveType type) {
+    if (!m_initialized) return false;
+    
+    bool found = false;
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        SlaveInfo* slave = m_slaves.find(address);
+        if (slave) {
+            slave->type = type;
+            slave->configStepIndex = 0;
+            found = true;
+        }
+        xSemaphoreGive(m_slavesMutex);
+    }
+    return found;
+}
+
 bool SlaveManager::removeSlave(uint8_t address) {
     if (!m_initialized) return false;
 
     if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        auto it = m_slaves.find(address);
-        if (it != m_slaves.end()) {
-            m_slaves.erase(it);
+        SlaveInfo* slave = m_slaves.find(address);
+        if (slave && slave->onProbation) {
+            m_probationCount--;
+        }
+        if (m_slaves.erase(address)) {
+            publishSnapshot();
             xSemaphoreGive(m_slavesMutex);
             ESP_LOGI(TAG, "Removed slave 0x%02X", address);
             return true;
@@ -147,63 +260,164 @@ void SlaveManager::enablePinging(bool enable) {
     if (!m_initialized) return;
 
     m_pingEnabled = enable;
-    
-    if (enable) {
-        xTimerStart(m_pingTimer, 0);
-        ESP_LOGI(TAG, "Pinging enabled");
-    } else {
-        xTimerStop(m_pingTimer, 0);
-        ESP_LOGI(TAG, "Pinging disabled");
-    }
+    ESP_LOGI(TAG, "Pinging %s", enable ? "enabled" : "disabled");
 }
 
 bool SlaveManager::sendDimCommand(uint8_t address, uint8_t channel, uint8_t level, uint16_t rampTime) {
-    Command cmd;
-    cmd.type = Command::DIM_COMMAND;
-    cmd.address = address;
-    cmd.channel = channel;
-    cmd.level = level;
-    cmd.rampTime = rampTime;
-    
-    return xQueueSend(m_commandQueue, &cmd, pdMS_TO_TICKS(50)) == pdTRUE;
+    return queueLevel({CommandCoalescer::Kind::DIM, address, channel, level, rampTime, 0});
 }
 
 bool SlaveManager::sendDimUCommand(uint8_t address, uint8_t channel, uint8_t level, uint16_t rampTime) {
-    Command cmd;
-    cmd.type = Command::DIMU_COMMAND;
-    cmd.address = address;
-    cmd.channel = channel;
-    cmd.level = level;
-    cmd.rampTime = rampTime;
-    
-    return xQueueSend(m_commandQueue, &cmd, pdMS_TO_TICKS(50)) == pdTRUE;
+    return queueLevel({CommandCoalescer::Kind::DIMU, address, channel, level, rampTime, 0});
 }
 
-SlaveManager::SlaveState SlaveManager::getSlaveState(uint8_t address) const {
-    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        auto it = m_slaves.find(address);
-        SlaveState state = (it != m_slaves.end()) ? it->second.state : SlaveState::OFFLINE;
+bool SlaveManager::sendDimCommandAcked(uint8_t address, uint8_t channel, uint8_t level, uint16_t rampTime,
+                                       uint32_t timeoutMs, DeliveryCallback callback, void* context) {
+    if (!m_initialized || !callback) return false;
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) != pdTRUE) return false;
+    
+    SlaveInfo* slave = m_slaves.find(address);
+    Delivery* delivery = nullptr;
+    if (slave && slave->type != SlaveType::IO_48 && slave->type != SlaveType::UNKNOWN &&
+        channel >= 1 && channel <= SlaveDevices::DIMMER_CHANNELS) {
+        for (Delivery& candidate : m_deliveries) {
+            if (candidate.state == DeliveryState::FREE) {
+                delivery = &candidate;
+                break;
+            }
+        }
+    }
+    
+    CommandCoalescer::Kind kind = (slave && slave->type == SlaveType::DIMU8)
+        ? CommandCoalescer::Kind::DIMU : CommandCoalescer::Kind::DIM;
+    CommandCoalescer::Entry entry = {kind, address, channel, level, rampTime, 0};
+    if (!delivery || !m_dimLevels.post(entry)) {
         xSemaphoreGive(m_slavesMutex);
-        return state;
+        return false;
+    }
+    noteTargetLevel(entry);
+    
+    // The older level for the channel will not be sent again
+    for (Delivery& older : m_deliveries) {
+        if ((older.state == DeliveryState::QUEUED || older.state == DeliveryState::SENT) &&
+            older.entry.address == address && older.entry.channel == channel) {
+            older.state = DeliveryState::DONE;
+            older.outcome = DeliveryOutcome::SUPERSEDED;
+        }
     }
     
-    return SlaveState::OFFLINE;
+    int64_t now = esp_timer_get_time();
+    *delivery = {DeliveryState::QUEUED, DeliveryOutcome::FAILED, 0, entry, 0,
+                 now, now + static_cast<int64_t>(timeoutMs) * 1000, callback, context};
+    xSemaphoreGive(m_slavesMutex);
+    return true;
 }
 
-std::vector<uint8_t> SlaveManager::getOnlineSlaves() const {
-    std::vector<uint8_t> online;
+SlaveManager::DeliveryStats SlaveManager::getDeliveryStats() const {
+    DeliveryStats stats = {{}, m_resendCount, 0};
+    for (size_t i = 0; i < static_cast<size_t>(DeliveryOutcome::COUNT); i++) {
+        stats.outcomes[i] = m_deliveryOutcomes[i];
+    }
+    for (const Delivery& delivery : m_deliveries) {
+        if (delivery.state != DeliveryState::FREE) stats.inFlight++;
+    }
+    return stats;
+}
+
+bool SlaveManager::sendDimLevels(uint8_t address, const ChannelLevel* levels, size_t count, bool universal) {
+    CommandCoalescer::Kind kind = universal ? CommandCoalescer::Kind::DIMU : CommandCoalescer::Kind::DIM;
+    bool queued = true;
     
-    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        for (const auto& pair : m_slaves) {
-            if (pair.second.state == SlaveState::ONLINE || 
-                pair.second.state == SlaveState::CONFIGURED) {
-                online.push_back(pair.first);
+    for (size_t i = 0; i < count; i++) {
+        queued &= queueLevel({kind, address, levels[i].channel, levels[i].level, levels[i].rampTime, 0});
+    }
+    return queued;
+}
+
+void SlaveManager::setMaxLevelsPerFrame(size_t count) {
+    if (count < 1) count = 1;
+    if (count > CrestronProtocol::MAX_LEVELS_PER_FRAME) count = CrestronProtocol::MAX_LEVELS_PER_FRAME;
+    m_maxLevelsPerFrame = count;
+}
+
+bool SlaveManager::queueLevel(const CommandCoalescer::Entry& entry) {
+    // Sent in the next COMMAND (or idle CONFIG) slot. The caller never waits
+    // for the mutex: the bus task notes the target level when the frame goes
+    // out, and recallScene() checks the table for levels still waiting
+    return m_dimLevels.post(entry);
+}
+
+SlaveManager::SlaveState SlaveManager::getSlaveState(uint8_t address) const {
+    SlaveState state = SlaveState::OFFLINE;
+    
+    m_snapshot.read([&](const StatusSnapshot& snapshot) {
+        uint8_t position = snapshot.position[address];
+        state = position ? snapshot.slaves[position - 1].state : SlaveState::OFFLINE;
+    });
+    
+    return state;
+}
+
+bool SlaveManager::getSlaveStats(uint8_t address, PollStats& stats) const {
+    bool found = false;
+    
+    m_snapshot.read([&](const StatusSnapshot& snapshot) {
+        uint8_t position = snapshot.position[address];
+        found = position != 0;
+        if (found) {
+            stats = snapshot.slaves[position - 1];
+        }
+    });
+    
+    return found;
+}
+
+size_t SlaveManager::getOnlineSlaves(uint8_t* addresses, size_t maxCount) const {
+    size_t count = 0;
+    
+    m_snapshot.read([&](const StatusSnapshot& snapshot) {
+        count = 0;
+        for (size_t i = 0; i < snapshot.count && count < maxCount; i++) {
+            const PollStats& slave = snapshot.slaves[i];
+            if (slave.state == SlaveState::ONLINE || 
+                slave.state == SlaveState::CONFIGURED) {
+                addresses[count++] = slave.address;
             }
         }
-        xSemaphoreGive(m_slavesMutex);
-    }
+    });
+    
+    return count;
+}
+
+size_t SlaveManager::getPollStats(PollStats* stats, size_t maxCount) const {
+    size_t count = 0;
+    
+    m_snapshot.read([&](const StatusSnapshot& snapshot) {
+        count = snapshot.count < maxCount ? snapshot.count : maxCount;
+        memcpy(stats, snapshot.slaves, count * sizeof(PollStats));
+    });
     
-    return online;
+    return count;
+}
+
+void SlaveManager::publishSnapshot() {
+    m_snapshot.write([this](StatusSnapshot& snapshot) {
+        for (size_t i = 0; i < snapshot.count; i++) {
+            snapshot.position[snapshot.slaves[i].address] = 0;
+        }
+        
+        snapshot.count = static_cast<uint16_t>(m_slaves.size());
+        for (size_t i = 0; i < snapshot.count; i++) {
+            const SlaveInfo& slave = m_slaves.at(i);
+            uint8_t address = m_slaves.addressAt(i);
+            snapshot.slaves[i] = {address, slave.state, slave.type, slave.configStepIndex, slave.backoffLevel,
+                                  slave.pollCount, slave.pollIntervalMs,
+                                  slave.latencyEwmaUs, slave.timeoutRatio, slave.failureStreak,
+                                  slave.onProbation, slave.lastSeenTime, slave.bytesSent,
+                                  slave.bytesReceived, slave.errorCount, slave.probationCount};
+            snapshot.position[address] = static_cast<uint8_t>(i + 1);
+        }
+    });
 }
 
 // Static task functions
@@ -212,176 +426,1062 @@ void SlaveManager::taskFunction(void* parameter) {
     instance->handleTask();
 }
 
-void SlaveManager::pingTimerCallback(TimerHandle_t timer) {
-    SlaveManager* instance = static_cast<SlaveManager*>(pvTimerGetTimerID(timer));
-    if (instance && instance->m_pingEnabled) {
-        // Queue a ping command
-        Command cmd;
-        cmd.type = Command::PING;
-        xQueueSend(instance->m_commandQueue, &cmd, 0);
+void SlaveManager::slotTimerCallback(void* arg) {
+    static_cast<SlaveManager*>(arg)->startNextSlot();
+}
+
+void SlaveManager::startNextSlot() {
+    if (!m_slotsRunning) return;
+    
+    if (xQueueSend(m_slotQueue, &m_nextSlot, 0) != pdTRUE) {
+        // Only one slot is armed at a time, so the queue should be empty;
+        // try again shortly rather than stall the schedule
+        m_skippedSlots++;
+        esp_timer_start_once(m_slotTimer, BusSchedule::GUARD_US);
     }
 }
 
+void SlaveManager::armSlot(uint8_t index, int64_t startUs) {
+    if (!m_slotsRunning) return;
+    
+    m_nextSlot = {index, startUs};
+    int64_t now = esp_timer_get_time();
+    esp_timer_start_once(m_slotTimer, startUs > now ? static_cast<uint64_t>(startUs - now) : 1);
+}
+
+void SlaveManager::noteWireTime(uint32_t wireUs) {
+    // Frames go out back to back behind any still queued
+    int64_t now = esp_timer_get_time();
+    m_wireIdleUs = (m_wireIdleUs > now ? m_wireIdleUs : now) + wireUs;
+}
+
 void SlaveManager::handleTask() {
-    Command command;
-    RS485Communication::Message rxMessage;
+    SlotStart slot;
+    RS485Communication::Message* rxMessage;
     
     while (true) {
         // Process incoming messages (non-blocking)
-        while (m_rs485.receiveMessage(rxMessage, 0)) {
-            handleIncomingMessage(rxMessage);
+        while ((rxMessage = m_rs485.receiveMessage(0)) != nullptr) {
+            handleIncomingMessage(*rxMessage);
+            m_rs485.releaseMessage(rxMessage);
         }
         
-        // Process queued commands
-        if (xQueueReceive(m_commandQueue, &command, pdMS_TO_TICKS(10)) == pdTRUE) {
-            switch (command.type) {
-                case Command::PING:
-                    processPingCycle();
-                    break;
-                    
-                case Command::DIM_COMMAND: {
-                    // Build DIM command message
-                    uint8_t dimData[10] = {
-                        command.address, 0x08, 0x1D, 0x00,
-                        static_cast<uint8_t>(command.rampTime >> 8),
-                        static_cast<uint8_t>(command.rampTime & 0xFF),
-                        0x00, command.level, command.channel, command.level
-                    };
-                    m_rs485.sendMessage(dimData, sizeof(dimData));
-                    break;
-                }
-                
-                case Command::DIMU_COMMAND: {
-                    // Build DIMU command message
-                    uint8_t dimUData[13] = {
-                        command.address, 0x0B, 0x20, 0x01, 0x08, 0x1D, 0x00,
-                        static_cast<uint8_t>(command.rampTime >> 8),
-                        static_cast<uint8_t>(command.rampTime & 0xFF),
-                        0x00, command.level, command.channel, command.level
-                    };
-                    m_rs485.sendMessage(dimUData, sizeof(dimUData));
-                    break;
-                }
-                
-                case Command::CONFIG_STEP:
-                    processConfigurationStep(command.address);
-                    break;
+        // Everything this task puts on the wire goes out in a slot
+        if (xQueueReceive(m_slotQueue, &slot, pdMS_TO_TICKS(10)) == pdTRUE) {
+            int64_t nextStartUs = runSlot(slot);
+            armSlot(static_cast<uint8_t>((slot.index + 1) % BusSchedule::SLOT_COUNT), nextStartUs);
+        }
+        
+        checkSceneRecall();
+        reportDeliveries();
+    }
+}
+
+int64_t SlaveManager::runSlot(const SlotStart& slot) {
+    int64_t now = esp_timer_get_time();
+    int64_t endUs = slot.startUs + m_slotLengthUs[slot.index];
+    m_slotJitter.record(now - slot.startUs);
+    m_slotCount++;
+    
+    if (slot.index == 0) {
+        if (m_cycleStartUs != 0) {
+            m_cycleTime.record(slot.startUs - m_cycleStartUs);
+        }
+        m_cycleStartUs = slot.startUs;
+    }
+    
+    // Slots never run past their full length, so bulk frames and the reply
+    // window that end by this bound also end before the next POLL slot
+    int64_t nextPollUs = endUs;
+    for (size_t i = (slot.index + 1) % BusSchedule::SLOT_COUNT;
+         BusSchedule::SLOTS[i] != BusSchedule::SlotKind::POLL;
+         i = (i + 1) % BusSchedule::SLOT_COUNT) {
+        nextPollUs += m_slotLengthUs[i];
+    }
+    m_nextPollSlotUs = nextPollUs;
+    
+    // COMMAND and CONFIG slots lend themselves to each other when idle
+    BusSchedule::SlotUse use = BusSchedule::SlotUse::IDLE;
+    switch (BusSchedule::SLOTS[slot.index]) {
+        case BusSchedule::SlotKind::POLL:
+            if (m_pingEnabled) {
+                use = processPingCycle();
+            }
+            break;
+            
+        case BusSchedule::SlotKind::COMMAND:
+            if (dispatchLevelFrame()) {
+                use = BusSchedule::SlotUse::COMMAND;
+            } else if (advanceConfigurations()) {
+                use = BusSchedule::SlotUse::CONFIG;
+            }
+            break;
+            
+        case BusSchedule::SlotKind::CONFIG:
+            if (advanceConfigurations()) {
+                use = BusSchedule::SlotUse::CONFIG;
+            } else if (dispatchLevelFrame()) {
+                use = BusSchedule::SlotUse::COMMAND;
+            }
+            break;
+    }
+    m_slotUses[static_cast<size_t>(use)]++;
+    
+    int64_t doneUs = esp_timer_get_time();
+    if (doneUs > endUs) {
+        m_slotOverruns++;
+        m_slotOverrun.record(doneUs - endUs);
+    }
+    
+    // A poll blocks until its transaction ends and data frames are only
+    // queued, so the slot ends a guard time after the last queued frame
+    // (or the break after a missed ping) has left the wire. A whole cycle of
+    // idle slots falls back to full-length slots so a quiet bus does not spin.
+    if (use == BusSchedule::SlotUse::IDLE) {
+        m_idleSlots++;
+        if (m_idleSlots >= BusSchedule::SLOT_COUNT) {
+            return endUs > doneUs ? endUs : doneUs;
+        }
+    } else {
+        m_idleSlots = 0;
+    }
+    
+    int64_t nextStartUs = (m_wireIdleUs > doneUs ? m_wireIdleUs : doneUs) + BusSchedule::GUARD_US;
+    if (nextStartUs < endUs) {
+        m_endedSlots++;
+    }
+    return nextStartUs;
+}
+
+SlaveManager::SlotStats SlaveManager::getSlotStats() const {
+    SlotStats stats = {m_cycleUs, m_slotCount, m_skippedSlots, m_endedSlots, m_slotOverruns, m_breakCount, {}};
+    for (size_t i = 0; i < static_cast<size_t>(BusSchedule::SlotUse::COUNT); i++) {
+        stats.uses[i] = m_slotUses[i];
+    }
+    return stats;
+}
+
+bool SlaveManager::dispatchLevelFrame() {
+    CommandCoalescer::Entry batch[CrestronProtocol::MAX_LEVELS_PER_FRAME];
+    
+    // Levels leave the table only as fast as the bus drains them; once in a
+    // TX lane they can no longer be merged with newer ones
+    if (m_rs485.getLaneDepth(RS485Communication::TxLane::CONTROL) >= MAX_QUEUED_LEVEL_FRAMES) return false;
+    
+    // Every pending channel of the oldest slave in line goes in one frame
+    size_t count = m_dimLevels.takeBatch(batch, m_maxLevelsPerFrame);
+    if (count == 0) return false;
+    
+    // Delivery and recall bookkeeping must see every frame, so a frame only
+    // goes out under the mutex; without it the batch waits for the next slot
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) != pdTRUE) {
+        m_dimLevels.restoreBatch(batch, count);
+        return false;
+    }
+    
+    RS485Communication::Message* frame = m_rs485.acquireTxMessage();
+    if (!frame) {
+        // Pool exhausted; try again in the next slot
+        xSemaphoreGive(m_slavesMutex);
+        m_dimLevels.restoreBatch(batch, count);
+        return false;
+    }
+    
+    // DIM:  [addr] [len] [0x1D] [0x00] entries...
+    // DIMU: [addr] [len] [0x20] [0x01] [inner len] [0x1D] [0x00] entries...
+    uint8_t* d = frame->data;
+    size_t innerLength = 2 + count * CrestronProtocol::DIM_ENTRY_LENGTH;
+    size_t offset = 0;
+    d[offset++] = batch[0].address;
+    if (batch[0].kind == CommandCoalescer::Kind::DIM) {
+        d[offset++] = static_cast<uint8_t>(innerLength);
+    } else {
+        d[offset++] = static_cast<uint8_t>(innerLength + 3);
+        d[offset++] = CrestronProtocol::DIMU_COMMAND;
+        d[offset++] = 0x01;
+        d[offset++] = static_cast<uint8_t>(innerLength);
+    }
+    d[offset++] = CrestronProtocol::DIM_COMMAND;
+    d[offset++] = 0x00;
+    
+    for (size_t i = 0; i < count; i++) {
+        const CommandCoalescer::Entry& entry = batch[i];
+        d[offset++] = static_cast<uint8_t>(entry.rampTime >> 8);
+        d[offset++] = static_cast<uint8_t>(entry.rampTime & 0xFF);
+        d[offset++] = 0x00;
+        d[offset++] = entry.level;
+        d[offset++] = entry.channel;
+        d[offset++] = entry.level;
+    }
+    frame->length = offset;
+    
+    bool submitted = submitLevelFrame(frame, batch, count);
+    xSemaphoreGive(m_slavesMutex);
+    if (!submitted) return false;
+    m_levelFrameCount++;
+    return true;
+}
+
+bool SlaveManager::submitLevelFrame(RS485Communication::Message* frame,
+                                    const CommandCoalescer::Entry* batch, size_t count) {
+    // Tagged under the mutex, so a recall starting meanwhile cannot miss
+    // (or double-count) a frame
+    uint16_t scenePending = 0;
+    if (m_recallTag != 0) {
+        for (size_t i = 0; i < count; i++) {
+            if (batch[i].tag == m_recall.tag) scenePending++;
+        }
+    }
+    frame->txTag = scenePending > 0 ? m_recall.tag : 0;
+    
+    size_t length = frame->length;
+    bool submitted = m_rs485.submitTxMessage(frame);
+    if (submitted) {
+        // The slave is polled early, in case the command produced a reply
+        m_controlFrames++;
+        noteWireTime(length * m_characterUs);
+        markSentDeliveries(batch, count);
+        for (size_t i = 0; i < count; i++) {
+            noteTargetLevel(batch[i]);
+        }
+        
+        SlaveInfo* slave = m_slaves.find(batch[0].address);
+        if (slave) {
+            slave->bytesSent += length;
+            if (slave->pendingCommands < UINT8_MAX) {
+                slave->pendingCommands++;
             }
         }
+        
+        if (scenePending > 0) {
+            m_recall.frames++;
+            m_recall.levelsPending -= std::min(scenePending, m_recall.levelsPending);
+        }
+    }
+    return submitted;
+}
+
+void SlaveManager::noteTargetLevel(const CommandCoalescer::Entry& entry) {
+    SlaveInfo* slave = m_slaves.find(entry.address);
+    if (!slave || entry.channel < 1 || entry.channel > SlaveDevices::DIMMER_CHANNELS) return;
+    
+    slave->targetLevels[entry.channel - 1] = entry.level;
+    slave->knownLevels |= static_cast<uint8_t>(1 << (entry.channel - 1));
+}
+
+size_t SlaveManager::recallScene(const SceneStore::Scene& scene) {
+    if (!m_initialized) return 0;
+    
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
     }
+    
+    if (m_recallTag != 0) {
+        ESP_LOGD(TAG, "Scene recall %u superseded", m_recall.tag);
+    }
+    
+    m_nextRecallTag++;
+    if (m_nextRecallTag == 0) m_nextRecallTag = 1;
+    const uint16_t tag = m_nextRecallTag;
+    
+    SceneRecallStats stats = {};
+    for (size_t i = 0; i < scene.count; i++) {
+        const SceneStore::Target& target = scene.targets[i];
+        
+        // Another bus's slave, or a channel this slave does not have
+        SlaveInfo* slave = m_slaves.find(target.address);
+        if (!slave || slave->type == SlaveType::IO_48 || slave->type == SlaveType::UNKNOWN ||
+            target.channel < 1 || target.channel > SlaveDevices::DIMMER_CHANNELS) {
+            continue;
+        }
+        
+        // A level still waiting in the table is the channel's target; the
+        // table only holds levels posted since the last frame went out
+        uint8_t targetLevel = slave->targetLevels[target.channel - 1];
+        bool known = (slave->knownLevels & static_cast<uint8_t>(1 << (target.channel - 1))) != 0;
+        if (m_dimLevels.pendingLevel(target.address, target.channel, targetLevel)) {
+            known = true;
+        }
+        if (known && targetLevel == target.level) {
+            stats.skipped++;
+            continue;
+        }
+        
+        CommandCoalescer::Kind kind = slave->type == SlaveType::DIMU8
+            ? CommandCoalescer::Kind::DIMU : CommandCoalescer::Kind::DIM;
+        CommandCoalescer::Entry entry = {kind, target.address, target.channel,
+                                         target.level, target.rampTime, tag};
+        if (!m_dimLevels.post(entry)) {
+            stats.truncated++;
+            continue;
+        }
+        noteTargetLevel(entry);
+        stats.levels++;
+    }
+    if (stats.truncated > 0) {
+        ESP_LOGW(TAG, "Level table full; scene \"%s\" truncated by %u levels", scene.name, stats.truncated);
+    }
+    
+    m_recall = {tag, stats.levels, 0, stats, esp_timer_get_time(), xTaskGetTickCount()};
+    m_recallTag = tag;
+    xSemaphoreGive(m_slavesMutex);
+    
+    // Completion (even of an empty recall) is reported by the bus task
+    return stats.levels;
+}
+
+void SlaveManager::checkSceneRecall() {
+    if (m_recallTag == 0) return;
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) != pdTRUE) return;
+    
+    // A newer level posted for a scene channel replaces the tagged entry, so
+    // an empty table also means nothing of the scene is left to send
+    if (m_dimLevels.pending() == 0) {
+        m_recall.levelsPending = 0;
+    }
+    
+    RS485Communication::TaggedTxStats tx = m_rs485.getTaggedTxStats();
+    bool onWire = tx.tag == m_recall.tag && tx.frames >= m_recall.frames;
+    bool sent = m_recall.levelsPending == 0 && (m_recall.frames == 0 || onWire);
+    bool expired = xTaskGetTickCount() - m_recall.startTick >= pdMS_TO_TICKS(SceneConfig::RECALL_TIMEOUT_MS);
+    if (!sent && !expired) {
+        xSemaphoreGive(m_slavesMutex);
+        return;
+    }
+    
+    SceneRecallStats stats = m_recall.stats;
+    stats.frames = m_recall.frames;
+    stats.complete = sent;
+    if (tx.tag == m_recall.tag && tx.frames > 0) {
+        stats.wireSpanUs = static_cast<uint32_t>(tx.lastDoneUs - tx.firstStartUs);
+        stats.totalUs = static_cast<uint32_t>(tx.lastDoneUs - m_recall.startUs);
+    }
+    unsigned framesOnWire = tx.tag == m_recall.tag ? tx.frames : 0;
+    m_recallTag = 0;
+    xSemaphoreGive(m_slavesMutex);
+    
+    if (sent && stats.frames > 0) {
+        m_sceneSpan.record(stats.wireSpanUs);
+    }
+    m_lastRecall.write([&stats](SceneRecallStats& last) { last = stats; });
+    
+    if (sent) {
+        ESP_LOGI(TAG, "Scene recalled: %u levels in %u frames over %u us (%u skipped)",
+                 stats.levels, stats.frames, static_cast<unsigned>(stats.wireSpanUs), stats.skipped);
+    } else {
+        ESP_LOGW(TAG, "Scene recall incomplete: %u of %u frames sent", framesOnWire, stats.frames);
+    }
+}
+
+bool SlaveManager::getLastSceneRecall(SceneRecallStats& stats) const {
+    if (m_lastRecall.version() == 0) return false;
+    
+    m_lastRecall.read([&stats](const SceneRecallStats& last) { stats = last; });
+    return true;
 }
 
-void SlaveManager::processPingCycle() {
-    if (m_slaves.empty()) return;
+BusSchedule::SlotUse SlaveManager::processPingCycle() {
+    if (m_slaves.empty() && !m_discoveryEnabled) return BusSchedule::SlotUse::IDLE;
+
+    uint8_t address = 0;
+    SlaveState previousState = SlaveState::OFFLINE;
+    bool shouldPing = false;
+    bool shouldProbe = false;
 
     if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-        // Get current slave to ping
-        auto it = m_slaves.begin();
-        std::advance(it, m_currentSlaveIndex % m_slaves.size());
+        TickType_t now = xTaskGetTickCount();
+        SlaveInfo* slave = nullptr;
         
-        uint8_t address = it->first;
-        SlaveInfo& slave = it->second;
+        // A probe that is due takes the cycle before a slave is picked, so
+        // no slave loses its place in the round-robin
+        m_cyclesSinceProbe++;
+        if (m_discoveryEnabled && m_cyclesSinceProbe >= DiscoveryConfig::SLOT_SHARE) {
+            shouldProbe = nextProbeAddress(now, address);
+        }
+        if (!shouldProbe) {
+            slave = selectSlaveToPoll(now, address);
+            if (!slave && m_discoveryEnabled) {
+                // Nobody is due: the slot is free anyway
+                shouldProbe = nextProbeAddress(now, address);
+            }
+        }
+        if (shouldProbe) {
+            m_cyclesSinceProbe = 0;
+        }
         
-        // Check for ping timeout on previously sent pings
-        if (slave.state == SlaveState::PING_SENT && isPingTimeout(slave)) {
-            handlePingTimeout(address);
+        if (slave) {
+            if (slave->pollCount > 0) {
+                uint32_t intervalMs = now - slave->lastPingTime;
+                slave->pollIntervalMs = slave->pollIntervalMs == 0
+                    ? intervalMs : (slave->pollIntervalMs * 7 + intervalMs) / 8;
+            }
+            slave->pollCount++;
+            slave->pendingCommands = 0;
+            slave->bytesSent += BusSchedule::PING_FRAME_LENGTH;
+            
+            previousState = slave->state;
+            slave->state = SlaveState::PING_SENT;
+            slave->lastPingTime = now;
+            shouldPing = true;
+            publishSnapshot();
         }
         
-        // Send ping if slave is offline or online (not during configuration)
-        if (slave.state == SlaveState::OFFLINE || 
-            slave.state == SlaveState::ONLINE ||
-            slave.state == SlaveState::CONFIGURED) {
+        xSemaphoreGive(m_slavesMutex);
+    }
+
+    if (shouldProbe) {
+        probeAddress(address);
+        return BusSchedule::SlotUse::PROBE;
+    }
+    if (!shouldPing) return BusSchedule::SlotUse::IDLE;
+
+    RS485Communication::TransactionResult result = pollAddress(address);
+    if (result.status != RS485Communication::TransactionStatus::SEND_FAILED) {
+        m_totalPings++;
+    }
+
+    switch (result.status) {
+        case RS485Communication::TransactionStatus::REPLY: {
+            size_t replyLength = result.reply->length;
+            size_t matched = handleIncomingMessage(*result.reply);
+            m_rs485.releaseMessage(result.reply);
             
-            if (sendPingToSlave(address)) {
-                slave.state = SlaveState::PING_SENT;
-                slave.lastPingTime = xTaskGetTickCount();
-                m_totalPings++;
+            if (matched == 0) {
+                // Something answered in the window, but not the expected reply
+                handlePingTimeout(address);
+                break;
             }
+            
+            if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
+                SlaveInfo* slave = m_slaves.find(address);
+                if (slave) {
+                    // A slave that asked for configuration (now or before a
+                    // missed ping) carries on with its sequence
+                    if (slave->configRequested && slave->type != SlaveType::UNKNOWN) {
+                        slave->state = SlaveState::CONFIGURING;
+                    } else {
+                        slave->state = (previousState == SlaveState::CONFIGURED)
+                            ? SlaveState::CONFIGURED : SlaveState::ONLINE;
+                    }
+                    slave->lastTurnaroundUs = result.turnaroundUs;
+                    slave->backoffLevel = 0;
+                    slave->bytesReceived += replyLength;
+                    recordPollOutcome(address, *slave, true, result.turnaroundUs, xTaskGetTickCount());
+                    settleDeliveries(address, *slave, true);
+                    publishSnapshot();
+                }
+                xSemaphoreGive(m_slavesMutex);
+            }
+            m_successfulPings++;
+            break;
+        }
+            
+        case RS485Communication::TransactionStatus::TIMEOUT:
+        case RS485Communication::TransactionStatus::COLLISION:
+            handlePingTimeout(address);
+            break;
+            
+        case RS485Communication::TransactionStatus::SEND_FAILED:
+            if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
+                SlaveInfo* slave = m_slaves.find(address);
+                if (slave) {
+                    slave->state = previousState;
+                    publishSnapshot();
+                }
+                xSemaphoreGive(m_slavesMutex);
+            }
+            break;
+    }
+    return BusSchedule::SlotUse::POLL;
+}
+
+RS485Communication::TransactionResult SlaveManager::pollAddress(uint8_t address) {
+    // A new poll starts a new exchange: drop any fragment left over from the
+    // last one and attribute replies to this slave
+    m_parser.reset();
+    m_parser.setPolledAddress(address);
+    
+    // Until the request is on the wire there is no deadline to be late for
+    m_transaction = {true, address, ReplyKind::PING, 0, INT64_MAX};
+    
+    // Bulk traffic queued meanwhile must be off the wire by the next poll
+    m_rs485.setNextPollDeadline(m_nextPollSlotUs);
+    
+    // Control frames still queued go out after the ping, so an answer does
+    // not confirm them
+    m_pollWireSeq = m_controlFrames - static_cast<uint32_t>(m_rs485.getLaneDepth(RS485Communication::TxLane::CONTROL));
+
+    // The transaction blocks this task until the reply or the deadline, so
+    // the slave table is not held across it
+    RS485Communication::TransactionResult result = sendPingToSlave(address);
+    if (result.status != RS485Communication::TransactionStatus::SEND_FAILED) {
+        m_transaction.sentUs = result.txDoneUs;
+        m_transaction.deadlineUs = result.txDoneUs + m_rs485.getSettings().pingTimeoutUs;
+    } else {
+        m_transaction.active = false;
+    }
+    return result;
+}
+
+void SlaveManager::enableDiscovery(bool enable) {
+    if (enable && !m_discoveryEnabled) {
+        m_discoveryCursor = DiscoveryConfig::FIRST_ADDRESS;
+        m_sweepStartTime = xTaskGetTickCount();
+        m_sweepProbes = 0;
+    }
+    m_discoveryEnabled = enable;
+    ESP_LOGI(TAG, "Discovery %s", enable ? "enabled" : "disabled");
+}
+
+SlaveManager::DiscoveryStats SlaveManager::getDiscoveryStats() const {
+    DiscoveryStats stats = {m_discoveryEnabled, m_probeCount, m_discoveredCount, m_sweepCount,
+                            m_lastSweepMs, m_estimatedSweepMs, m_discoveryCursor};
+    return stats;
+}
+
+bool SlaveManager::nextProbeAddress(TickType_t now, uint8_t& address) {
+    constexpr uint32_t RANGE = DiscoveryConfig::LAST_ADDRESS - DiscoveryConfig::FIRST_ADDRESS + 1;
+    
+    for (uint32_t n = 0; n < RANGE; n++) {
+        uint8_t candidate = m_discoveryCursor;
+        m_discoveryCursor = candidate < DiscoveryConfig::LAST_ADDRESS
+            ? candidate + 1 : DiscoveryConfig::FIRST_ADDRESS;
+        
+        // Passes repeat for as long as discovery is on, so devices
+        // connected later are found on the next one
+        if (candidate == DiscoveryConfig::FIRST_ADDRESS && m_sweepProbes > 0) {
+            m_lastSweepMs = (now - m_sweepStartTime) * portTICK_PERIOD_MS;
+            m_sweepCount++;
+            m_sweepStartTime = now;
+            m_sweepProbes = 0;
         }
         
-        // Move to next slave
-        m_currentSlaveIndex = (m_currentSlaveIndex + 1) % m_slaves.size();
+        if (m_slaves.find(candidate)) continue;
         
-        xSemaphoreGive(m_slavesMutex);
+        m_sweepProbes++;
+        uint32_t elapsedMs = (now - m_sweepStartTime) * portTICK_PERIOD_MS;
+        m_estimatedSweepMs = static_cast<uint32_t>(static_cast<uint64_t>(elapsedMs) *
+                                                   (RANGE - m_slaves.size()) / m_sweepProbes);
+        address = candidate;
+        return true;
     }
+    
+    // Every address is in the table
+    return false;
 }
 
-void SlaveManager::initializeConfigTemplates() {
-    // This would contain the configuration sequences from your original code
-    // Simplified here for brevity - you'd expand this with all the config data
+void SlaveManager::probeAddress(uint8_t address) {
+    m_probeCount++;
     
-    // DIM8 configuration template
-    ConfigData dim8Config;
-    dim8Config.type = SlaveType::DIM8;
-    // Add all the dimSetup sequences here
+    RS485Communication::TransactionResult result = pollAddress(address);
+    if (result.status != RS485Communication::TransactionStatus::REPLY) {
+        // Silence (or a collision): nothing there, or nothing ready yet
+        return;
+    }
     
-    // DIMU8 configuration template  
-    ConfigData dimU8Config;
-    dimU8Config.type = SlaveType::DIMU8;
-    // Add all the dimUSetup sequences here
+    // Added before the reply is handled, so a configuration request in it
+    // is recorded against the new slave
+    SlaveType type = typeHintFor(address);
+    bool added = false;
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
+        if (!m_slaves.find(address)) {
+            SlaveInfo slave = makeSlaveInfo(address, type);
+            slave.state = SlaveState::PING_SENT;
+            m_slaves.insert(address, slave);
+            added = true;
+        }
+        xSemaphoreGive(m_slavesMutex);
+    }
     
-    m_configTemplates[SlaveType::DIM8] = dim8Config;
-    m_configTemplates[SlaveType::DIMU8] = dimU8Config;
+    size_t replyLength = result.reply->length;
+    size_t matched = handleIncomingMessage(*result.reply);
+    m_rs485.releaseMessage(result.reply);
+    if (!added) return;
+    
+    // Waits as long as it takes: given up here, the slave would be left in
+    // PING_SENT, which is never due, and never be polled again
+    if (xSemaphoreTake(m_slavesMutex, portMAX_DELAY) == pdTRUE) {
+        SlaveInfo* slave = m_slaves.find(address);
+        if (slave && matched == 0) {
+            // Noise in the window rather than an answer
+            m_slaves.erase(address);
+            slave = nullptr;
+        }
+        if (slave) {
+            slave->state = (slave->configRequested && slave->type != SlaveType::UNKNOWN)
+                ? SlaveState::CONFIGURING : SlaveState::ONLINE;
+            slave->lastTurnaroundUs = result.turnaroundUs;
+            slave->lastPingTime = xTaskGetTickCount();
+            slave->pollCount = 1;
+            slave->bytesSent = BusSchedule::PING_FRAME_LENGTH;
+            slave->bytesReceived = replyLength;
+            recordPollOutcome(address, *slave, true, result.turnaroundUs, slave->lastPingTime);
+        }
+        publishSnapshot();
+        xSemaphoreGive(m_slavesMutex);
+    }
+    
+    if (matched > 0) {
+        m_discoveredCount++;
+        ESP_LOGI(TAG, "Discovered slave 0x%02X (type %d)", address, static_cast<int>(type));
+    }
 }
 
-bool SlaveManager::sendPingToSlave(uint8_t address) {
-    return m_rs485.sendPing(address);
+SlaveManager::SlaveType SlaveManager::typeHintFor(uint8_t address) {
+    // A configuration request does not say what the device is, so only the
+    // addresses this installation assigns by model are typed automatically
+    switch (address) {
+        case SlaveDevices::IO_48_ADDRESS:   return SlaveType::IO_48;
+        case SlaveDevices::DIM8_ADDRESS:    return SlaveType::DIM8;
+        case SlaveDevices::DIMU8_ADDRESS:   return SlaveType::DIMU8;
+        default:                            return SlaveType::UNKNOWN;
+    }
 }
 
-bool SlaveManager::sendTimeSync(uint8_t address) {
-    uint8_t timeSyncData[10] = {
-        address, 0x08, 0x08, 0x0E, 0x15, 0x45, 0x29, 0x05, 0x20, 0x20
+SlaveManager::SlaveInfo* SlaveManager::selectSlaveToPoll(TickType_t now, uint8_t& address) {
+    // Configuring slaves keep being polled between their configuration
+    // frames; ones that missed pings wait out their backoff
+    auto due = [now](const SlaveInfo& slave) {
+        return (slave.state == SlaveState::OFFLINE ||
+                slave.state == SlaveState::ONLINE ||
+                slave.state == SlaveState::CONFIGURING ||
+                slave.state == SlaveState::CONFIGURED) &&
+               static_cast<int32_t>(now - slave.nextPollTime) >= 0;
     };
-    return m_rs485.sendMessage(timeSyncData, sizeof(timeSyncData));
+    
+    // A slave with commands outstanding goes ahead of the rotation so its
+    // response comes back on the next poll rather than a lap later. Priority
+    // picks alternate with rotation picks, and each scan starts after the
+    // last slave prioritised, so steady dimming cannot starve the rest
+    if (!m_lastPollPrioritised) {
+        const size_t count = m_slaves.size();
+        for (size_t n = 0; n < count; n++) {
+            size_t index = (m_priorityCursor + n) % count;
+            SlaveInfo& slave = m_slaves.at(index);
+            if (slave.pendingCommands > 0 && due(slave)) {
+                m_priorityCursor = (index + 1) % count;
+                m_lastPollPrioritised = true;
+                address = m_slaves.addressAt(index);
+                return &slave;
+            }
+        }
+    }
+    
+    m_lastPollPrioritised = false;
+    return m_slaves.next(address, due);
+}
+
+static_assert(ConfigSequences::STEP_MS == CrestronTiming::CONFIG_STEP_DELAY_MS,
+              "Sequence timing assumes the configured step delay");
+
+const ConfigSequences::Sequence& SlaveManager::sequenceFor(SlaveType type) {
+    switch (type) {
+        case SlaveType::DIMU8:
+            return ConfigSequences::DIMU8;
+        case SlaveType::IO_48:
+            return ConfigSequences::IO48;
+        case SlaveType::DIM8:
+        default:
+            return ConfigSequences::DIM8;
+    }
+}
+
+bool SlaveManager::advanceConfigurations() {
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+    
+    TickType_t now = xTaskGetTickCount();
+    size_t count = m_slaves.size();
+    bool stepped = false;
+    
+    // One step per slot, so slaves configuring at the same time take turns;
+    // the search starts after the slave that went last
+    if (m_rs485.getLaneDepth(RS485Communication::TxLane::BULK) < MAX_QUEUED_CONFIG_FRAMES) {
+        for (size_t n = 0; n < count; n++) {
+            size_t index = (m_configCursor + n) % count;
+            SlaveInfo& slave = m_slaves.at(index);
+            if (!slave.configRequested || slave.state != SlaveState::CONFIGURING) continue;
+            if (static_cast<int32_t>(now - slave.configNextTime) < 0) continue;
+            
+            stepped = processConfigurationStep(m_slaves.addressAt(index), slave, now);
+            m_configCursor = (index + 1) % count;
+            break;
+        }
+    }
+    
+    xSemaphoreGive(m_slavesMutex);
+    return stepped;
 }
 
-void SlaveManager::handleIncomingMessage(const RS485Communication::Message& message) {
-    // Parse incoming messages and update slave states
-    // This would implement the protocol parsing from your checkResp() function
+bool SlaveManager::processConfigurationStep(uint8_t address, SlaveInfo& slave, TickType_t now) {
+    const ConfigSequences::Sequence& sequence = sequenceFor(slave.type);
     
-    if (message.length >= 2) {
-        uint8_t prefix = message.data[0];
-        uint8_t command = message.data[1];
+    if (slave.configStepIndex < sequence.count) {
+        const ConfigSequences::Step& step = sequence.steps[slave.configStepIndex];
         
-        if (prefix == CrestronProtocol::TO_MASTER_PREFIX && command == CrestronProtocol::PING_COMMAND) {
-            // Ping response received
-            m_successfulPings++;
+        RS485Communication::Message* frame = m_rs485.acquireTxMessage();
+        if (!frame) return false;
+        
+        // Tables hold the frame without its address byte
+        frame->data[0] = address;
+        memcpy(&frame->data[1], step.frame, step.length);
+        frame->length = step.length + 1;
+        
+        // The bulk lane holds the frame back until it fits before the next
+        // poll, so configuration never delays other slaves' pings
+        size_t length = frame->length;
+        if (!m_rs485.submitTxMessage(frame, RS485Communication::TxLane::BULK)) return false;
+        noteWireTime(length * m_characterUs);
+        slave.bytesSent += length;
+        
+        uint32_t settleMs = step.settleMs > CrestronTiming::CONFIG_STEP_DELAY_MS
+            ? step.settleMs : CrestronTiming::CONFIG_STEP_DELAY_MS;
+        slave.configStepIndex++;
+        slave.configNextTime = now + pdMS_TO_TICKS(settleMs);
+    }
+    
+    if (slave.configStepIndex >= sequence.count) {
+        slave.configRequested = false;
+        slave.state = SlaveState::CONFIGURED;
+        m_configurationCount++;
+        publishSnapshot();
+        ESP_LOGI(TAG, "Slave 0x%02X configured in %u steps", address, static_cast<unsigned>(sequence.count));
+    }
+    return true;
+}
+
+RS485Communication::TransactionResult SlaveManager::sendPingToSlave(uint8_t address) {
+    RS485Communication::Message* frame = m_rs485.acquireTxMessage();
+    if (!frame) {
+        return {RS485Communication::TransactionStatus::SEND_FAILED, nullptr, 0, 0};
+    }
+    
+    frame->data[0] = address;
+    frame->data[1] = CrestronProtocol::PING_COMMAND;
+    frame->length = 2;
+    return m_rs485.transact(frame, m_rs485.getSettings().pingTimeoutUs);
+}
+
+size_t SlaveManager::handleIncomingMessage(const RS485Communication::Message& message) {
+    // A delimited chunk may hold part of a frame or several frames; the parser
+    // carries partial frames over to the next chunk
+    const uint8_t* data = message.data;
+    size_t remaining = message.length;
+    size_t matched = 0;
+    
+    while (remaining > 0) {
+        size_t consumed = m_parser.feed(data, remaining);
+        data += consumed;
+        remaining -= consumed;
+        
+        if (!m_parser.hasFrame()) continue;
+        
+        const CrestronFrameParser::Frame& frame = m_parser.frame();
+        if (frame.direction == CrestronFrameParser::Direction::MASTER_TO_SLAVE) {
+            handleFrame(frame, message.timestampUs);
+            continue;
+        }
+        
+        switch (matchReply(frame, message.timestampUs)) {
+            case ReplyMatch::MATCHED:
+                matched++;
+                handleFrame(frame, message.timestampUs);
+                break;
+                
+            case ReplyMatch::LATE:
+                // Too late to count as an answer, but the data is still the
+                // polled slave's (the next poll resets the parser)
+                m_lateReplyCount++;
+                ESP_LOGD(TAG, "Late reply from 0x%02X, %lld us past deadline", frame.address,
+                         static_cast<long long>(message.timestampUs - m_transaction.deadlineUs));
+                handleFrame(frame, message.timestampUs);
+                break;
+                
+            case ReplyMatch::UNMATCHED:
+                m_unmatchedReplyCount++;
+                ESP_LOGD(TAG, "Unmatched s>m frame, len %u", frame.length);
+                break;
+        }
+    }
+    
+    return matched;
+}
+
+SlaveManager::ReplyMatch SlaveManager::matchReply(const CrestronFrameParser::Frame& frame, int64_t timestampUs) const {
+    if (!m_transaction.active || frame.address != m_transaction.address) {
+        return ReplyMatch::UNMATCHED;
+    }
+    
+    if (timestampUs > m_transaction.deadlineUs) {
+        return ReplyMatch::LATE;
+    }
+    
+    if (m_transaction.expected == ReplyKind::DATA && frame.isPing) {
+        return ReplyMatch::UNMATCHED;
+    }
+    
+    return ReplyMatch::MATCHED;
+}
+
+void SlaveManager::handleFrame(const CrestronFrameParser::Frame& frame, int64_t timestampUs) {
+    InboundEvent event;
+    if (!InboundDecoder::decode(frame, timestampUs, event)) {
+        // Our own frames are not echoed, so this is another master on the bus
+        ESP_LOGD(TAG, "m>s 0x%02X len %u", frame.address, frame.length);
+        return;
+    }
+    
+    m_eventCounts[static_cast<size_t>(event.type)]++;
+    
+    switch (event.type) {
+        case InboundEventType::PING_ACK:
+            ESP_LOGV(TAG, "Ping reply from 0x%02X", event.address);
+            break;
+            
+        case InboundEventType::CONFIG_REQUEST:
+            ESP_LOGI(TAG, "Slave 0x%02X requested configuration", event.address);
             
             if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-                // Find the slave that was pinged and update its state
-                for (auto& pair : m_slaves) {
-                    if (pair.second.state == SlaveState::PING_SENT) {
-                        pair.second.state = SlaveState::ONLINE;
-                        break;
-                    }
+                // Replies carry the polled address, which indexes the table directly
+                SlaveInfo* slave = m_slaves.find(event.address);
+                if (slave) {
+                    // (Re)start from the first step; the reply handling moves
+                    // the slave to CONFIGURING and the steps follow its polls
+                    slave->configRequested = true;
+                    slave->configStepIndex = 0;
+                    slave->configNextTime = xTaskGetTickCount();
+                    slave->knownLevels = 0;
+                }
+                xSemaphoreGive(m_slavesMutex);
+            }
+            break;
+            
+        case InboundEventType::INPUT_CHANGE:
+            ESP_LOGD(TAG, "Input %u of 0x%02X %s", event.index, event.address,
+                     event.value ? "pressed" : "released");
+            
+            // A slave reports one change per poll; poll it again first in
+            // case more are waiting (a keypad press and release, say)
+            if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
+                SlaveInfo* slave = m_slaves.find(event.address);
+                if (slave && slave->pendingCommands < UINT8_MAX) {
+                    slave->pendingCommands++;
                 }
                 xSemaphoreGive(m_slavesMutex);
             }
+            break;
+            
+        case InboundEventType::DIMMER_FEEDBACK:
+            ESP_LOGD(TAG, "Channel %u of 0x%02X at %u", event.index, event.address, event.value);
+            break;
+            
+        default:
+            ESP_LOGD(TAG, "s>m 0x%02X len %u", event.address, event.length);
+            break;
+    }
+    
+    dispatchEvent(event);
+}
+
+bool SlaveManager::subscribe(InboundEventType type, InboundCallback callback, void* context) {
+    if (!m_initialized || !callback || type >= InboundEventType::COUNT) return false;
+    
+    // The mutex only serializes subscribers; the bus task never waits on it here
+    bool added = false;
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        size_t count = m_subscriberCount.load(std::memory_order_relaxed);
+        if (count < MAX_SUBSCRIBERS) {
+            m_subscribers[count] = {type, callback, context};
+            m_subscriberCount.store(count + 1, std::memory_order_release);
+            added = true;
         }
-        // Add more message parsing logic here
+        xSemaphoreGive(m_slavesMutex);
+    }
+    
+    if (!added) {
+        ESP_LOGW(TAG, "Cannot subscribe to %s events", InboundDecoder::typeName(type));
     }
+    return added;
 }
 
-bool SlaveManager::isPingTimeout(const SlaveInfo& slave) const {
-    uint32_t elapsed = xTaskGetTickCount() - slave.lastPingTime;
-    return elapsed > pdMS_TO_TICKS(CrestronTiming::PING_TIMEOUT_MS);
+void SlaveManager::dispatchEvent(const InboundEvent& event) {
+    size_t count = m_subscriberCount.load(std::memory_order_acquire);
+    bool timed = false;
+    
+    for (size_t i = 0; i < count; i++) {
+        const Subscriber& subscriber = m_subscribers[i];
+        if (subscriber.type != event.type) continue;
+        
+        if (!timed) {
+            m_eventLatency.record(esp_timer_get_time() - event.timestampUs);
+            timed = true;
+        }
+        subscriber.callback(event, subscriber.context);
+    }
 }
 
 void SlaveManager::handlePingTimeout(uint8_t address) {
+    bool known = false;
+    
     if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-        auto it = m_slaves.find(address);
-        if (it != m_slaves.end()) {
-            it->second.state = SlaveState::OFFLINE;
-            it->second.errorCount++;
+        SlaveInfo* slave = m_slaves.find(address);
+        if (slave) {
+            slave->state = SlaveState::OFFLINE;
+            slave->errorCount++;
             
-            // Send break signal on timeout
-            m_rs485.sendBreak();
+            // Back off: REPING_DELAY_MS after the first miss, doubling up to
+            // MAX_REPING_DELAY_MS, so dead slaves stop taking poll slots
+            uint32_t delayMs = CrestronTiming::REPING_DELAY_MS << slave->backoffLevel;
+            if (delayMs >= CrestronTiming::MAX_REPING_DELAY_MS) {
+                delayMs = CrestronTiming::MAX_REPING_DELAY_MS;
+            } else {
+                slave->backoffLevel++;
+            }
+            TickType_t now = xTaskGetTickCount();
+            slave->nextPollTime = now + pdMS_TO_TICKS(delayMs);
+            recordPollOutcome(address, *slave, false, 0, now);
+            settleDeliveries(address, *slave, false);
+            publishSnapshot();
+            known = true;
         }
         xSemaphoreGive(m_slavesMutex);
     }
+    
+    // Send break signal on timeout, outside the table lock; the POLL slot
+    // has room for it after the reply window
+    if (known && m_rs485.sendBreak()) {
+        m_controlFrames++;
+        m_breakCount++;
+        noteWireTime(m_characterUs + CrestronTiming::BREAK_DURATION_US);
+    }
 }
 
-void SlaveManager::processConfigurationStep(uint8_t address) {
-    // Implement configuration step processing
-    // This would break down the large configuration sequences into smaller steps
-}
\ No newline at end of file
+void SlaveManager::recordPollOutcome(uint8_t address, SlaveInfo& slave, bool answered,
+                                     uint32_t turnaroundUs, TickType_t now) {
+    // Integer EWMA: each sample moves the average 1/2^EWMA_SHIFT of the way
+    auto smooth = [](uint32_t average, uint32_t sample) {
+        int64_t step = (static_cast<int64_t>(sample) - average) / (1 << LinkQuality::EWMA_SHIFT);
+        return static_cast<uint32_t>(average + step);
+    };
+    
+    if (answered) {
+        slave.latencyEwmaUs = slave.lastSeenTime == 0 ? turnaroundUs : smooth(slave.latencyEwmaUs, turnaroundUs);
+        slave.lastSeenTime = now != 0 ? now : 1;
+        slave.failureStreak = 0;
+    } else if (slave.failureStreak < UINT8_MAX) {
+        slave.failureStreak++;
+    }
+    slave.timeoutRatio = static_cast<uint16_t>(smooth(slave.timeoutRatio, answered ? 0 : LinkQuality::RATIO_SCALE));
+    
+    // Hysteresis between the two ratios, so a slave near the limit does
+    // not flip in and out of the rotation on every poll
+    if (!slave.onProbation && slave.pollCount >= LinkQuality::MIN_POLLS &&
+        slave.timeoutRatio > LinkQuality::PROBATION_ENTER_RATIO) {
+        slave.onProbation = true;
+        slave.probationCount++;
+        m_probationCount++;
+        ESP_LOGW(TAG, "Slave 0x%02X on probation: %u/%u polls missed", address,
+                 static_cast<unsigned>(slave.timeoutRatio), static_cast<unsigned>(LinkQuality::RATIO_SCALE));
+    } else if (slave.onProbation && slave.timeoutRatio < LinkQuality::PROBATION_EXIT_RATIO) {
+        slave.onProbation = false;
+        m_probationCount--;
+        ESP_LOGI(TAG, "Slave 0x%02X back in rotation", address);
+    }
+    
+    // On probation the slave waits at least PROBATION_POLL_MS between polls,
+    // on top of any backoff after a miss
+    if (slave.onProbation) {
+        TickType_t probationTime = now + pdMS_TO_TICKS(LinkQuality::PROBATION_POLL_MS);
+        if (static_cast<int32_t>(probationTime - slave.nextPollTime) > 0) {
+            slave.nextPollTime = probationTime;
+        }
+    }
+}
+
+void SlaveManager::markSentDeliveries(const CommandCoalescer::Entry* batch, size_t count) {
+    for (Delivery& delivery : m_deliveries) {
+        if (delivery.state != DeliveryState::QUEUED) continue;
+        
+        for (size_t i = 0; i < count; i++) {
+            const CommandCoalescer::Entry& entry = batch[i];
+            if (entry.address != delivery.entry.address || entry.channel != delivery.entry.channel) continue;
+            
+            // A plain level posted since took this one's place in the table
+            if (entry.level != delivery.entry.level || entry.rampTime != delivery.entry.rampTime) {
+                delivery.state = DeliveryState::DONE;
+                delivery.outcome = DeliveryOutcome::SUPERSEDED;
+            } else {
+                delivery.state = DeliveryState::SENT;
+                delivery.attempts++;
+                delivery.controlSeq = m_controlFrames;
+            }
+            break;
+        }
+    }
+}
+
+void SlaveManager::settleDeliveries(uint8_t address, const SlaveInfo& slave, bool answered) {
+    int64_t now = esp_timer_get_time();
+    
+    for (Delivery& delivery : m_deliveries) {
+        if (delivery.state != DeliveryState::SENT || delivery.entry.address != address) continue;
+        // Signed difference, so the sequence may wrap
+        if (static_cast<int32_t>(m_pollWireSeq - delivery.controlSeq) < 0) continue;
+        
+        if (answered) {
+            delivery.state = DeliveryState::DONE;
+            delivery.outcome = delivery.attempts > 1 ? DeliveryOutcome::RETRIED : DeliveryOutcome::DELIVERED;
+            continue;
+        }
+        
+        // The slave did not answer after the frame, so it may have missed
+        // it as well (a timeout sends a break, which resets its receiver)
+        if (delivery.attempts >= DeliveryConfig::MAX_ATTEMPTS || now >= delivery.deadlineUs) {
+            delivery.state = DeliveryState::DONE;
+            delivery.outcome = DeliveryOutcome::FAILED;
+        } else if (slave.targetLevels[delivery.entry.channel - 1] != delivery.entry.level) {
+            // A newer level is already queued; resending would undo it
+            delivery.state = DeliveryState::DONE;
+            delivery.outcome = DeliveryOutcome::SUPERSEDED;
+        } else if (m_dimLevels.post(delivery.entry)) {
+            delivery.state = DeliveryState::QUEUED;
+            m_resendCount++;
+        } else {
+            delivery.state = DeliveryState::DONE;
+            delivery.outcome = DeliveryOutcome::FAILED;
+        }
+    }
+}
+
+void SlaveManager::reportDeliveries() {
+    size_t count = 0;
+    
+    if (xSemaphoreTake(m_slavesMutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+    int64_t now = esp_timer_get_time();
+    for (Delivery& delivery : m_deliveries) {
+        if (delivery.state == DeliveryState::FREE) continue;
+        
+        if (delivery.state != DeliveryState::DONE && now >= delivery.deadlineUs) {
+            // The level may still go out; it just was not confirmed in time
+            delivery.state = DeliveryState::DONE;
+            delivery.outcome = DeliveryOutcome::FAILED;
+        }
+        if (delivery.state == DeliveryState::DONE) {
+            m_finishedDeliveries[count++] = delivery;
+            delivery.state = DeliveryState::FREE;
+        }
+    }
+    xSemaphoreGive(m_slavesMutex);
+    
+    // Callbacks run without the table lock, so they may send more levels
+    for (size_t i = 0; i < count; i++) {
+        const Delivery& delivery = m_finishedDeliveries[i];
+        DeliveryReport report = {delivery.entry.address, delivery.entry.channel, delivery.entry.level,
+                                 delivery.outcome, delivery.attempts,
+                                 static_cast<uint32_t>(now - delivery.startUs)};
+        m_deliveryOutcomes[static_cast<size_t>(delivery.outcome)]++;
+        if (delivery.outcome == DeliveryOutcome::DELIVERED || delivery.outcome == DeliveryOutcome::RETRIED) {
+            m_deliveryLatency.record(report.elapsedUs);
+        }
+        delivery.callback(report, delivery.context);
+    }
+}
@@ -19,7 +19,7 @@ void showStartup() {
     M5.Lcd.println("Initializing...");
 }
 
-void updateMainScreen(bool pingEnabled, uint32_t heap, uint32_t tx, uint32_t rx, uint32_t err, uint32_t successPings, uint32_t totalPings, const uint8_t* slaveAddresses, const char** slaveNames, int slaveCount, bool dim1, bool dim2) {
+void updateMainScreen(bool pingEnabled, uint32_t heap, uint32_t tx, uint32_t rx, uint32_t err, uint32_t successPings, uint32_t totalPings, const uint8_t* slaveAddresses, const char** slaveNames, const uint8_t* missedPercent, const bool* onProbation, int slaveCount, bool dim1, bool dim2) {
     M5.Lcd.fillScreen(BLACK);
     M5.Lcd.setTextColor(WHITE);
     M5.Lcd.setTextSize(2);
@@ -38,11 +38,21 @@ void updateMainScreen(bool pingEnabled, uint32_t heap, uint32_t tx, uint32_t rx,
     M5.Lcd.println("Slaves:");
     for (int i = 0; i < slaveCount; ++i) {
         const uint8_t addr = slaveAddresses[i];
-        M5.Lcd.printf("0x%02X %s\n", addr, slaveNames[i]);
+        // Share of recent polls missed; "P" while on probation
+        M5.Lcd.setTextColor(onProbation[i] ? MAGENTA : WHITE);
+        M5.Lcd.printf("0x%02X %s %3u%%%s\n", addr, slaveNames[i], missedPercent[i], onProbation[i] ? " P" : "");
     }
+    M5.Lcd.setTextColor(WHITE);
 
     M5.Lcd.setCursor(0, 220);
     M5.Lcd.printf("A:Ping  B:Dim1%s  C:Dim2%s", dim1 ? "*" : " ", dim2 ? "*" : " ");
 }
 
+void showLatency(const char* label, uint32_t p50, uint32_t p95, uint32_t p99, uint32_t max) {
+    M5.Lcd.setTextSize(1);
+    M5.Lcd.setTextColor(WHITE, BLACK);
+    M5.Lcd.setCursor(0, 205);
+    M5.Lcd.printf("%s us p50:%u p95:%u p99:%u max:%u", label, p50, p95, p99, max);
+}
+
 } // namespace UI
@@ -2,18 +2,49 @@
 #include <M5Stack.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
 #include <esp_log.h>
 
 #include "config.h"
+#include "Esp32UartTransport.h"
+#include "HeapTracker.h"
 #include "RS485Communication.h"
+#include "SceneStore.h"
 #include "SlaveManager.h"
 #include "UI.h"
 
 static const char* TAG = "CrestronMaster";
 
-// Global objects
-RS485Communication g_rs485;
+// Global objects: one UART transport, RS485Communication and SlaveManager per bus
+Esp32UartTransport g_uart;
+RS485Communication g_rs485(g_uart, RS485Config::BUSES[0]);
 SlaveManager g_slaveManager(g_rs485);
+#if CRESTRON_BUS_COUNT > 1
+Esp32UartTransport g_uartBus2;
+RS485Communication g_rs485Bus2(g_uartBus2, RS485Config::BUSES[1]);
+SlaveManager g_slaveManagerBus2(g_rs485Bus2);
+#endif
+
+RS485Communication* const g_buses[] = {
+    &g_rs485,
+#if CRESTRON_BUS_COUNT > 1
+    &g_rs485Bus2,
+#endif
+};
+
+SlaveManager* const g_slaveManagers[] = {
+    &g_slaveManager,
+#if CRESTRON_BUS_COUNT > 1
+    &g_slaveManagerBus2,
+#endif
+};
+
+// Scenes span both buses; each SlaveManager sends the targets it owns
+SceneStore g_scenes;
+
+// Input changes from the bus tasks, logged by the UI task
+constexpr UBaseType_t INPUT_EVENT_QUEUE_LENGTH = 16;
+QueueHandle_t g_inputEvents = nullptr;
 
 // UI state
 volatile bool g_pingEnabled = false;
@@ -25,7 +56,24 @@ void setupTasks();
 void uiTaskFunction(void* parameter);
 void statusTaskFunction(void* parameter);
 void handleButtons();
-void updateDisplay();
+void showMainScreen();
+void pollSerialCommands();
+void handleSerialCommand(const char* command);
+void handleCaptureCommand(const char* arguments);
+void printLatency(const char* label, const LatencyHistogram& histogram);
+void printBusLatency(RS485Communication& bus);
+void printPollStats(SlaveManager& manager, const char* busName);
+void printLinkStats(SlaveManager& manager, const char* busName);
+void printHeapAllocations();
+void printStackHeadroom();
+void setupDefaultScenes();
+bool recallStoredScene(const char* name, SceneStore::Scene& scene);
+void printScenes();
+void onInputChange(const SlaveManager::InboundEvent& event, void* context);
+void logInputEvents();
+void printInboundEvents();
+void printDiscovery();
+void printSlotStats();
 
 void setup() {
     // Initialize serial for debugging
@@ -43,27 +91,42 @@ void setup() {
     UI::begin();
     UI::showStartup();
     
-    // Initialize RS485 communication
-    if (!g_rs485.initialize()) {
-        ESP_LOGE(TAG, "Failed to initialize RS485");
-        M5.Lcd.setTextColor(RED);
-        M5.Lcd.println("RS485 FAILED!");
-        while (true) { delay(1000); }
-    }
-    
-    // Initialize slave manager
-    if (!g_slaveManager.initialize()) {
-        ESP_LOGE(TAG, "Failed to initialize slave manager");
-        M5.Lcd.setTextColor(RED);
-        M5.Lcd.println("SlaveManager FAILED!");
-        while (true) { delay(1000); }
+    for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+        // Initialize RS485 communication
+        if (!g_buses[i]->initialize()) {
+            ESP_LOGE(TAG, "Failed to initialize RS485 %s", RS485Config::BUSES[i].name);
+            M5.Lcd.setTextColor(RED);
+            M5.Lcd.println("RS485 FAILED!");
+            while (true) { delay(1000); }
+        }
+        
+        // Initialize slave manager
+        if (!g_slaveManagers[i]->initialize()) {
+            ESP_LOGE(TAG, "Failed to initialize slave manager for %s", RS485Config::BUSES[i].name);
+            M5.Lcd.setTextColor(RED);
+            M5.Lcd.println("SlaveManager FAILED!");
+            while (true) { delay(1000); }
+        }
     }
     
+    // Known slaves live on the first bus; slaves on further buses are added
+    // to that bus's SlaveManager
+
     // Add known slaves
     g_slaveManager.addSlave(SlaveDevices::IO_48_ADDRESS, SlaveManager::SlaveType::IO_48);
     g_slaveManager.addSlave(SlaveDevices::DIM8_ADDRESS, SlaveManager::SlaveType::DIM8);
     g_slaveManager.addSlave(SlaveDevices::DIMU8_ADDRESS, SlaveManager::SlaveType::DIMU8);
     
+    setupDefaultScenes();
+    
+    static StaticQueue_t inputEventQueue;
+    static uint8_t inputEventStorage[INPUT_EVENT_QUEUE_LENGTH * sizeof(SlaveManager::InboundEvent)];
+    g_inputEvents = xQueueCreateStatic(INPUT_EVENT_QUEUE_LENGTH, sizeof(SlaveManager::InboundEvent),
+                                       inputEventStorage, &inputEventQueue);
+    for (SlaveManager* manager : g_slaveManagers) {
+        manager->subscribe(SlaveManager::InboundEventType::INPUT_CHANGE, onInputChange);
+    }
+    
     // Setup additional tasks
     setupTasks();
     
@@ -75,34 +138,435 @@ void setup() {
     
     delay(1000);
     // initial display update
-    const uint8_t slaves[] = { SlaveDevices::IO_48_ADDRESS, SlaveDevices::DIM8_ADDRESS, SlaveDevices::DIMU8_ADDRESS };
-    const char* slaveNames[] = { "IO-48", "DIM8 ", "DIMU8" };
-    UI::updateMainScreen(g_pingEnabled, esp_get_free_heap_size(), g_rs485.getTransmitCount(), g_rs485.getReceiveCount(), g_rs485.getErrorCount(), g_slaveManager.getSuccessfulPings(), g_slaveManager.getTotalPings(), slaves, slaveNames, 3, g_dimRequest1, g_dimRequest2);
+    showMainScreen();
+    
+    // Everything from here on is steady state; the debug build counts any
+    // heap allocation made after this point ("heap" command)
+    HeapTracker::arm();
 }
 
 void loop() {
     // Main loop is minimal - most work done in FreeRTOS tasks
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    vTaskDelay(pdMS_TO_TICKS(50));
+    pollSerialCommands();
     
     // Watchdog-style status check
     static uint32_t lastStatusCheck = 0;
     if (millis() - lastStatusCheck > 5000) {
-        ESP_LOGI(TAG, "System status - Free heap: %d, RS485 TX: %d, RX: %d", 
+        LatencyHistogram::Summary wire = g_rs485.getEnqueueToWireHistogram().summarize();
+        LatencyHistogram::Summary turn = g_rs485.getTurnaroundHistogram().summarize();
+        ESP_LOGI(TAG, "System status - Free heap: %d, RS485 TX: %d, RX: %d, enqueue-to-wire p99: %d us, turnaround p99: %d us", 
                  esp_get_free_heap_size(),
                  g_rs485.getTransmitCount(),
-                 g_rs485.getReceiveCount());
+                 g_rs485.getReceiveCount(),
+                 wire.p99,
+                 turn.p99);
         lastStatusCheck = millis();
     }
 }
 
+void pollSerialCommands() {
+    static char line[32];
+    static size_t lineLength = 0;
+    
+    while (Serial.available()) {
+        char c = static_cast<char>(Serial.read());
+        if (c == '\r' || c == '\n') {
+            if (lineLength > 0) {
+                line[lineLength] = '\0';
+                handleSerialCommand(line);
+                lineLength = 0;
+            }
+        } else if (lineLength < sizeof(line) - 1) {
+            line[lineLength++] = c;
+        }
+    }
+}
+
+void handleSerialCommand(const char* command) {
+    if (strcmp(command, "lat") == 0) {
+        for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+            printBusLatency(*g_buses[i]);
+            Serial.printf("replies late: %u, unmatched: %u\n",
+                          g_slaveManagers[i]->getLateReplyCount(),
+                          g_slaveManagers[i]->getUnmatchedReplyCount());
+        }
+    } else if (strcmp(command, "lat reset") == 0) {
+        for (RS485Communication* bus : g_buses) {
+            bus->resetHistograms();
+        }
+        Serial.println("latency histograms cleared");
+    } else if (strncmp(command, "cap", 3) == 0 && (command[3] == '\0' || command[3] == ' ')) {
+        handleCaptureCommand(command + 3);
+    } else if (strcmp(command, "poll") == 0) {
+        for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+            printPollStats(*g_slaveManagers[i], RS485Config::BUSES[i].name);
+        }
+    } else if (strcmp(command, "link") == 0) {
+        for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+            printLinkStats(*g_slaveManagers[i], RS485Config::BUSES[i].name);
+        }
+    } else if (strcmp(command, "heap") == 0) {
+        printHeapAllocations();
+    } else if (strcmp(command, "stack") == 0) {
+        printStackHeadroom();
+    } else if (strcmp(command, "discover on") == 0 || strcmp(command, "discover off") == 0) {
+        bool enable = command[10] == 'n';
+        for (SlaveManager* manager : g_slaveManagers) {
+            manager->enableDiscovery(enable);
+        }
+        Serial.printf("discovery %s\n", enable ? "on" : "off");
+    } else if (strcmp(command, "discover") == 0) {
+        printDiscovery();
+    } else if (strcmp(command, "slots") == 0) {
+        printSlotStats();
+    } else if (strcmp(command, "events") == 0) {
+        printInboundEvents();
+    } else if (strcmp(command, "scenes") == 0) {
+        printScenes();
+    } else if (strncmp(command, "scene ", 6) == 0) {
+        static SceneStore::Scene scene;
+        if (!recallStoredScene(command + 6, scene)) {
+            Serial.printf("no scene \"%s\"\n", command + 6);
+        }
+    } else {
+        Serial.println("commands: lat, lat reset, poll, link, slots, heap, stack, events, discover, discover on, discover off, scenes, scene NAME, cap [BUS] [on|off|clear|dump]");
+    }
+}
+
+// "cap [BUS] [on|off|clear|dump]"; BUS is a bus name and defaults to the first bus
+void handleCaptureCommand(const char* arguments) {
+    while (*arguments == ' ') arguments++;
+    
+    size_t busIndex = 0;
+    for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+        size_t nameLength = strlen(RS485Config::BUSES[i].name);
+        if (strncmp(arguments, RS485Config::BUSES[i].name, nameLength) == 0 &&
+            (arguments[nameLength] == '\0' || arguments[nameLength] == ' ')) {
+            busIndex = i;
+            arguments += nameLength;
+            while (*arguments == ' ') arguments++;
+            break;
+        }
+    }
+    
+    RS485Communication& bus = *g_buses[busIndex];
+    const char* busName = RS485Config::BUSES[busIndex].name;
+    BusCapture& capture = bus.getCapture();
+    
+    if (strcmp(arguments, "on") == 0 || strcmp(arguments, "off") == 0) {
+        bool enable = arguments[1] == 'n';
+        if (bus.enableCapture(enable)) {
+            Serial.printf("%s capture %s (%u bytes in %s)\n", busName, enable ? "on" : "off",
+                          capture.getCapacity(), capture.inPsram() ? "PSRAM" : "internal RAM");
+        } else {
+            Serial.printf("%s capture buffer allocation failed\n", busName);
+        }
+    } else if (strcmp(arguments, "clear") == 0) {
+        capture.clear();
+        Serial.printf("%s capture cleared\n", busName);
+    } else if (strcmp(arguments, "dump") == 0) {
+        // Binary follows the length line; the host reads exactly that many bytes.
+        // Recording is paused first so the announced length stays accurate.
+        bool wasEnabled = capture.isEnabled();
+        capture.setEnabled(false);
+        Serial.printf("CAPTURE %u\n", capture.getDumpSize());
+        capture.dump(Serial, bus.getSettings().baudRate);
+        Serial.println();
+        capture.setEnabled(wasEnabled);
+    } else if (*arguments == '\0') {
+        Serial.printf("%s capture %s: %u frames, %u/%u bytes, %u dropped\n", busName,
+                      capture.isEnabled() ? "on" : "off", capture.getRecordCount(),
+                      capture.getUsedBytes(), capture.getCapacity(), capture.getDroppedCount());
+    } else {
+        Serial.println("usage: cap [BUS] [on|off|clear|dump]");
+    }
+}
+
+void printBusLatency(RS485Communication& bus) {
+    Serial.printf("%s latency (us)   count    p50    p95    p99    max\n", bus.getSettings().name);
+    printLatency("turnaround", bus.getTurnaroundHistogram());
+    
+    for (size_t i = 0; i < bus.getTurnaroundSlotCount(); i++) {
+        uint8_t address = 0;
+        const LatencyHistogram* histogram = bus.getTurnaroundHistogram(i, address);
+        if (histogram) {
+            char label[20];
+            snprintf(label, sizeof(label), "  slave 0x%02X", address);
+            printLatency(label, *histogram);
+        }
+    }
+    if (bus.getTurnaroundDroppedCount() > 0) {
+        Serial.printf("  %u more slaves without a histogram (%u replies); see \"link\" for their latency\n",
+                      bus.getTurnaroundDroppedAddresses(), bus.getTurnaroundDroppedCount());
+    }
+    
+    printLatency("inter-arrival", bus.getInterArrivalHistogram());
+    printLatency("queue wait poll", bus.getTxQueueWaitHistogram(RS485Communication::TxLane::POLL));
+    printLatency("queue wait ctrl", bus.getTxQueueWaitHistogram(RS485Communication::TxLane::CONTROL));
+    printLatency("queue wait bulk", bus.getTxQueueWaitHistogram(RS485Communication::TxLane::BULK));
+    printLatency("enqueue-to-wire", bus.getEnqueueToWireHistogram());
+    Serial.printf("lane depth max poll/ctrl/bulk: %u/%u/%u, bulk held for poll: %u\n",
+                  bus.getLaneMaxDepth(RS485Communication::TxLane::POLL),
+                  bus.getLaneMaxDepth(RS485Communication::TxLane::CONTROL),
+                  bus.getLaneMaxDepth(RS485Communication::TxLane::BULK),
+                  bus.getBulkDeferCount());
+}
+
+void printPollStats(SlaveManager& manager, const char* busName) {
+    static SlaveManager::PollStats stats[SlaveTable<SlaveManager::SlaveInfo>::CAPACITY];
+    size_t count = manager.getPollStats(stats, sizeof(stats) / sizeof(stats[0]));
+    
+    Serial.printf("%s polls   addr  state     polls  every(ms)  rate/s  backoff\n", busName);
+    for (size_t i = 0; i < count; i++) {
+        const SlaveManager::PollStats& slave = stats[i];
+        bool online = slave.state == SlaveManager::SlaveState::ONLINE ||
+                      slave.state == SlaveManager::SlaveState::CONFIGURED;
+        float rate = slave.pollIntervalMs ? 1000.0f / slave.pollIntervalMs : 0.0f;
+        Serial.printf("          0x%02X  %-8s %6u %10u %7.1f %8u\n", slave.address,
+                      online ? "online" : "offline", slave.pollCount, slave.pollIntervalMs,
+                      rate, slave.backoffLevel);
+    }
+    
+    const CommandCoalescer& levels = manager.getDimLevels();
+    Serial.printf("dim levels: %u posted, %u merged, %u sent in %u frames, %u rejected, %u pending\n",
+                  levels.getPostedCount(), levels.getCoalescedCount(), levels.getTakenCount(),
+                  manager.getLevelFrameCount(), levels.getRejectedCount(), levels.pending());
+    
+    SlaveManager::DeliveryStats delivery = manager.getDeliveryStats();
+    uint32_t reported = 0;
+    for (size_t i = 0; i < static_cast<size_t>(SlaveManager::DeliveryOutcome::COUNT); i++) {
+        reported += delivery.outcomes[i];
+    }
+    uint32_t sends = reported + delivery.resends;
+    Serial.printf("acked levels: %u delivered, %u retried, %u failed, %u superseded, %u in flight\n",
+                  delivery.outcomes[static_cast<size_t>(SlaveManager::DeliveryOutcome::DELIVERED)],
+                  delivery.outcomes[static_cast<size_t>(SlaveManager::DeliveryOutcome::RETRIED)],
+                  delivery.outcomes[static_cast<size_t>(SlaveManager::DeliveryOutcome::FAILED)],
+                  delivery.outcomes[static_cast<size_t>(SlaveManager::DeliveryOutcome::SUPERSEDED)],
+                  delivery.inFlight);
+    Serial.printf("  %u resent (%.1f%% of sends)\n", delivery.resends,
+                  sends ? delivery.resends * 100.0f / sends : 0.0f);
+    printLatency("  ack time (us)", manager.getDeliveryLatencyHistogram());
+}
+
+void printLinkStats(SlaveManager& manager, const char* busName) {
+    static SlaveManager::PollStats stats[SlaveTable<SlaveManager::SlaveInfo>::CAPACITY];
+    size_t count = manager.getPollStats(stats, sizeof(stats) / sizeof(stats[0]));
+    TickType_t now = xTaskGetTickCount();
+    
+    Serial.printf("%s link    addr  latency(us)  missed  streak  seen(ms)  tx(B)   rx(B)  errors  probation\n", busName);
+    for (size_t i = 0; i < count; i++) {
+        const SlaveManager::PollStats& slave = stats[i];
+        char seen[12] = "never";
+        if (slave.lastSeenTime != 0) {
+            snprintf(seen, sizeof(seen), "%u", static_cast<unsigned>((now - slave.lastSeenTime) * portTICK_PERIOD_MS));
+        }
+        Serial.printf("          0x%02X %12u %6.1f%% %7u %9s %6u %7u %7u  %s (%u times)\n", slave.address,
+                      slave.latencyEwmaUs, slave.timeoutRatio * 100.0f / LinkQuality::RATIO_SCALE,
+                      slave.failureStreak, seen, slave.bytesSent, slave.bytesReceived, slave.errorCount,
+                      slave.onProbation ? "yes" : "no", slave.probationCount);
+    }
+    Serial.printf("%u slaves on probation\n", manager.getProbationCount());
+}
+
+void printHeapAllocations() {
+    if (!HeapTracker::isEnabled()) {
+        Serial.println("heap tracking is only built into the debug environment");
+        return;
+    }
+    
+    static HeapTracker::TaskCount counts[HeapTracker::MAX_TASKS];
+    size_t count = HeapTracker::snapshot(counts, HeapTracker::MAX_TASKS);
+    
+    Serial.printf("heap allocations since init: %u (%u outside a task)\n",
+                  HeapTracker::getTotalCount(), HeapTracker::getUntrackedCount());
+    for (size_t i = 0; i < count; i++) {
+        Serial.printf("  %-16s %8u allocs %10u bytes\n", counts[i].name,
+                      counts[i].allocations, counts[i].bytes);
+    }
+}
+
+// Least free stack each bus task has had, in bytes (ESP-IDF's unit)
+void printStackHeadroom() {
+    for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+        TaskHandle_t task = g_slaveManagers[i]->getTaskHandle();
+        if (!task) continue;
+        Serial.printf("%s slave manager: %u of %u stack bytes never used\n", RS485Config::BUSES[i].name,
+                      static_cast<unsigned>(uxTaskGetStackHighWaterMark(task)),
+                      static_cast<unsigned>(StackSizes::SLAVE_MANAGER));
+    }
+}
+
+void setupDefaultScenes() {
+    if (!g_scenes.begin()) {
+        ESP_LOGE(TAG, "Scene store unavailable");
+        return;
+    }
+    if (g_scenes.count() > 0) return;
+    
+    // First boot: the two button toggles, as scenes over both dimmers
+    struct Default {
+        const char* name;
+        uint8_t channel;
+        uint8_t level;
+        uint16_t rampTime;
+    };
+    static const Default defaults[] = {
+        {"ch1 full", 1, 255, 500},
+        {"ch1 off", 1, 0, 500},
+        {"ch2 half", 2, 128, 1000},
+        {"ch2 off", 2, 0, 1000},
+    };
+    
+    static SceneStore::Scene scene;
+    for (const Default& entry : defaults) {
+        strncpy(scene.name, entry.name, sizeof(scene.name) - 1);
+        scene.name[sizeof(scene.name) - 1] = '\0';
+        scene.count = 2;
+        scene.targets[0] = {SlaveDevices::DIM8_ADDRESS, entry.channel, entry.level, entry.rampTime};
+        scene.targets[1] = {SlaveDevices::DIMU8_ADDRESS, entry.channel, entry.level, entry.rampTime};
+        g_scenes.save(scene);
+    }
+    ESP_LOGI(TAG, "Stored %u default scenes", static_cast<unsigned>(g_scenes.count()));
+}
+
+// scene is the caller's buffer, so each task keeps its own off the stack
+bool recallStoredScene(const char* name, SceneStore::Scene& scene) {
+    if (!g_scenes.get(name, scene)) {
+        return false;
+    }
+    
+    size_t levels = 0;
+    for (SlaveManager* manager : g_slaveManagers) {
+        levels += manager->recallScene(scene);
+    }
+    ESP_LOGI(TAG, "Scene \"%s\": %u levels queued", scene.name, static_cast<unsigned>(levels));
+    return true;
+}
+
+void printScenes() {
+    Serial.printf("%u scenes:", static_cast<unsigned>(g_scenes.count()));
+    for (size_t i = 0; i < g_scenes.count(); i++) {
+        char name[SceneConfig::NAME_LENGTH];
+        if (g_scenes.nameAt(i, name, sizeof(name))) {
+            Serial.printf(" \"%s\"", name);
+        }
+    }
+    Serial.println();
+    
+    for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+        SlaveManager::SceneRecallStats recall;
+        if (!g_slaveManagers[i]->getLastSceneRecall(recall)) continue;
+        
+        LatencyHistogram::Summary span = g_slaveManagers[i]->getSceneSpanHistogram().summarize();
+        Serial.printf("%s last recall: %u levels in %u frames, %u skipped, %u truncated, on wire %u us, total %u us%s\n",
+                      RS485Config::BUSES[i].name, recall.levels, recall.frames, recall.skipped,
+                      recall.truncated, recall.wireSpanUs, recall.totalUs, recall.complete ? "" : " (incomplete)");
+        Serial.printf("%s recall span (us): %u recalls, p50 %u, p99 %u, max %u\n",
+                      RS485Config::BUSES[i].name, span.count, span.p50, span.p99, span.max);
+    }
+}
+
+// Runs on the bus task: hand the event to the UI task without waiting; a
+// full queue drops it rather than stall the bus. The payload pointer is not
+// valid once this returns, so the UI task only reads the decoded fields
+void onInputChange(const SlaveManager::InboundEvent& event, void* context) {
+    xQueueSend(g_inputEvents, &event, 0);
+}
+
+// UI task: log the input changes queued by the bus tasks
+void logInputEvents() {
+    SlaveManager::InboundEvent event;
+    while (xQueueReceive(g_inputEvents, &event, 0) == pdTRUE) {
+        ESP_LOGI(TAG, "Input %u on 0x%02X %s", event.index, event.address,
+                 event.value ? "pressed" : "released");
+    }
+}
+
+void printInboundEvents() {
+    for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+        const SlaveManager& manager = *g_slaveManagers[i];
+        Serial.printf("%s events:", RS485Config::BUSES[i].name);
+        for (size_t type = 0; type < static_cast<size_t>(SlaveManager::InboundEventType::COUNT); type++) {
+            SlaveManager::InboundEventType eventType = static_cast<SlaveManager::InboundEventType>(type);
+            Serial.printf(" %s %u,", InboundDecoder::typeName(eventType), manager.getInboundEventCount(eventType));
+        }
+        Serial.println();
+        printLatency("bus to callback", manager.getEventLatencyHistogram());
+    }
+}
+
+void printDiscovery() {
+    for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+        SlaveManager::DiscoveryStats stats = g_slaveManagers[i]->getDiscoveryStats();
+        Serial.printf("%s discovery %s: %u probes, %u found, next 0x%02X\n", RS485Config::BUSES[i].name,
+                      stats.enabled ? "on" : "off", stats.probes, stats.found, stats.nextAddress);
+        Serial.printf("  %u full sweeps, last %u ms, projected %u ms at the current load\n",
+                      stats.sweeps, stats.lastSweepMs, stats.estimatedSweepMs);
+    }
+}
+
+void printSlotStats() {
+    static const char* const USES[] = {"poll", "probe", "command", "config", "idle"};
+    static_assert(sizeof(USES) / sizeof(USES[0]) == static_cast<size_t>(BusSchedule::SlotUse::COUNT),
+                  "One label per slot use");
+    
+    for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+        SlaveManager& manager = *g_slaveManagers[i];
+        SlaveManager::SlotStats stats = manager.getSlotStats();
+        Serial.printf("%s slots: %u in %u us cycles, %u ended early, %u skipped, %u overruns, %u breaks\n",
+                      RS485Config::BUSES[i].name, stats.slots, stats.cycleUs,
+                      stats.ended, stats.skipped, stats.overruns, stats.breaks);
+        Serial.print("  used:");
+        for (size_t use = 0; use < static_cast<size_t>(BusSchedule::SlotUse::COUNT); use++) {
+            Serial.printf(" %u %s", stats.uses[use], USES[use]);
+        }
+        Serial.println();
+        Serial.printf("slot timing (us)   count    p50    p95    p99    max\n");
+        printLatency("start jitter", manager.getSlotJitterHistogram());
+        printLatency("cycle", manager.getCycleHistogram());
+        printLatency("overrun", manager.getSlotOverrunHistogram());
+    }
+}
+
+void printLatency(const char* label, const LatencyHistogram& histogram) {
+    LatencyHistogram::Summary summary = histogram.summarize();
+    Serial.printf("%-16s %8u %6u %6u %6u %6u\n", label,
+                  summary.count, summary.p50, summary.p95, summary.p99, summary.max);
+}
+
 void setupTasks() {
+    static StaticTask_t uiTaskBuffer;
+    static StackType_t uiTaskStack[StackSizes::UI_HANDLER];
+    static StaticTask_t statusTaskBuffer;
+    static StackType_t statusTaskStack[StackSizes::STATUS_MONITOR];
+    
     // Create UI handling task
-    xTaskCreate(uiTaskFunction, "UI_Handler", StackSizes::UI_HANDLER, 
-                nullptr, TaskPriorities::UI_HANDLER, nullptr);
+    xTaskCreateStatic(uiTaskFunction, "UI_Handler", StackSizes::UI_HANDLER, 
+                      nullptr, TaskPriorities::UI_HANDLER, uiTaskStack, &uiTaskBuffer);
     
     // Create status monitoring task
-    xTaskCreate(statusTaskFunction, "Status_Monitor", StackSizes::STATUS_MONITOR, 
-                nullptr, TaskPriorities::STATUS_MONITOR, nullptr);
+    xTaskCreateStatic(statusTaskFunction, "Status_Monitor", StackSizes::STATUS_MONITOR, 
+                      nullptr, TaskPriorities::STATUS_MONITOR, statusTaskStack, &statusTaskBuffer);
+}
+
+// Main screen for the known slaves on the first bus, with their link quality
+void showMainScreen() {
+    const uint8_t slaves[] = { SlaveDevices::IO_48_ADDRESS, SlaveDevices::DIM8_ADDRESS, SlaveDevices::DIMU8_ADDRESS };
+    const char* slaveNames[] = { "IO-48", "DIM8 ", "DIMU8" };
+    constexpr int SLAVE_COUNT = sizeof(slaves) / sizeof(slaves[0]);
+    uint8_t missedPercent[SLAVE_COUNT];
+    bool onProbation[SLAVE_COUNT];
+    
+    for (int i = 0; i < SLAVE_COUNT; i++) {
+        SlaveManager::PollStats stats;
+        bool known = g_slaveManager.getSlaveStats(slaves[i], stats);
+        missedPercent[i] = known ? static_cast<uint8_t>(stats.timeoutRatio * 100u / LinkQuality::RATIO_SCALE) : 0;
+        onProbation[i] = known && stats.onProbation;
+    }
+    
+    UI::updateMainScreen(g_pingEnabled, esp_get_free_heap_size(), g_rs485.getTransmitCount(), g_rs485.getReceiveCount(), g_rs485.getErrorCount(), g_slaveManager.getSuccessfulPings(), g_slaveManager.getTotalPings(), slaves, slaveNames, missedPercent, onProbation, SLAVE_COUNT, g_dimRequest1, g_dimRequest2);
 }
 
 void uiTaskFunction(void* parameter) {
@@ -112,13 +576,14 @@ void uiTaskFunction(void* parameter) {
         // Update M5Stack and handle buttons
         M5.update();
         handleButtons();
+        logInputEvents();
         
         // Update display if needed
         static TickType_t lastDisplayUpdate = 0;
         if (xTaskGetTickCount() - lastDisplayUpdate > pdMS_TO_TICKS(250)) {
-            const uint8_t slaves[] = { SlaveDevices::IO_48_ADDRESS, SlaveDevices::DIM8_ADDRESS, SlaveDevices::DIMU8_ADDRESS };
-            const char* slaveNames[] = { "IO-48", "DIM8 ", "DIMU8" };
-            UI::updateMainScreen(g_pingEnabled, esp_get_free_heap_size(), g_rs485.getTransmitCount(), g_rs485.getReceiveCount(), g_rs485.getErrorCount(), g_slaveManager.getSuccessfulPings(), g_slaveManager.getTotalPings(), slaves, slaveNames, 3, g_dimRequest1, g_dimRequest2);
+            showMainScreen();
+            LatencyHistogram::Summary turn = g_rs485.getTurnaroundHistogram().summarize();
+            UI::showLatency("Turn", turn.p50, turn.p95, turn.p99, turn.max);
             lastDisplayUpdate = xTaskGetTickCount();
         }
         
@@ -135,19 +600,22 @@ void statusTaskFunction(void* parameter) {
             ESP_LOGW(TAG, "Low memory warning: %d bytes free", freeHeap);
         }
         
-        // Check RS485 error rates
-        uint32_t totalMessages = g_rs485.getTransmitCount() + g_rs485.getReceiveCount();
-        uint32_t errorCount = g_rs485.getErrorCount();
-        
-        if (totalMessages > 100 && (errorCount * 100 / totalMessages) > 5) {
-            ESP_LOGW(TAG, "High RS485 error rate: %d%% (%d/%d)", 
-                     (errorCount * 100 / totalMessages), errorCount, totalMessages);
+        for (size_t i = 0; i < RS485Config::BUS_COUNT; i++) {
+            // Check RS485 error rates
+            uint32_t totalMessages = g_buses[i]->getTransmitCount() + g_buses[i]->getReceiveCount();
+            uint32_t errorCount = g_buses[i]->getErrorCount();
+            
+            if (totalMessages > 100 && (errorCount * 100 / totalMessages) > 5) {
+                ESP_LOGW(TAG, "High RS485 error rate on %s: %d%% (%d/%d)", RS485Config::BUSES[i].name,
+                         (errorCount * 100 / totalMessages), errorCount, totalMessages);
+            }
+            
+            // Check slave connectivity
+            static uint8_t online[SlaveTable<SlaveManager::SlaveInfo>::CAPACITY];
+            size_t onlineCount = g_slaveManagers[i]->getOnlineSlaves(online, sizeof(online));
+            ESP_LOGD(TAG, "Online slaves on %s: %u", RS485Config::BUSES[i].name, onlineCount);
         }
         
-        // Check slave connectivity
-        auto onlineSlaves = g_slaveManager.getOnlineSlaves();
-        ESP_LOGD(TAG, "Online slaves: %d", onlineSlaves.size());
-        
         vTaskDelay(pdMS_TO_TICKS(5000));
     }
 }
@@ -156,120 +624,24 @@ void handleButtons() {
     // Button A: Toggle pinging
     if (M5.BtnA.wasReleased()) {
         g_pingEnabled = !g_pingEnabled;
-        g_slaveManager.enablePinging(g_pingEnabled);
+        for (SlaveManager* manager : g_slaveManagers) {
+            manager->enablePinging(g_pingEnabled);
+        }
         
         ESP_LOGI(TAG, "Pinging %s", g_pingEnabled ? "enabled" : "disabled");
     }
     
-    // Button B: DIM commands
+    // Button B: channel 1 scenes
     if (M5.BtnB.wasReleased()) {
+        static SceneStore::Scene scene;
         g_dimRequest1 = !g_dimRequest1;
-        
-        if (g_dimRequest1) {
-            // Send DIM command to turn on channel 1 at full brightness
-            g_slaveManager.sendDimCommand(SlaveDevices::DIM8_ADDRESS, 1, 255, 500);
-            g_slaveManager.sendDimUCommand(SlaveDevices::DIMU8_ADDRESS, 1, 255, 500);
-            ESP_LOGI(TAG, "Dim ON commands sent");
-        } else {
-            // Send DIM command to turn off channel 1
-            g_slaveManager.sendDimCommand(SlaveDevices::DIM8_ADDRESS, 1, 0, 500);
-            g_slaveManager.sendDimUCommand(SlaveDevices::DIMU8_ADDRESS, 1, 0, 500);
-            ESP_LOGI(TAG, "Dim OFF commands sent");
-        }
+        recallStoredScene(g_dimRequest1 ? "ch1 full" : "ch1 off", scene);
     }
     
-    // Button C: Secondary DIM commands
+    // Button C: channel 2 scenes
     if (M5.BtnC.wasReleased()) {
+        static SceneStore::Scene scene;
         g_dimRequest2 = !g_dimRequest2;
-        
-        if (g_dimRequest2) {
-            // Send DIM command to turn on channel 2 at 50% brightness
-            g_slaveManager.sendDimCommand(SlaveDevices::DIM8_ADDRESS, 2, 128, 1000);
-            g_slaveManager.sendDimUCommand(SlaveDevices::DIMU8_ADDRESS, 2, 128, 1000);
-            ESP_LOGI(TAG, "Dim2 ON commands sent");
-        } else {
-            // Send DIM command to turn off channel 2
-            g_slaveManager.sendDimCommand(SlaveDevices::DIM8_ADDRESS, 2, 0, 1000);
-            g_slaveManager.sendDimUCommand(SlaveDevices::DIMU8_ADDRESS, 2, 0, 1000);
-            ESP_LOGI(TAG, "Dim2 OFF commands sent");
-        }
+        recallStoredScene(g_dimRequest2 ? "ch2 half" : "ch2 off", scene);
     }
 }
-
-void updateDisplay() {
-    M5.Lcd.fillScreen(BLACK);
-    M5.Lcd.setTextColor(WHITE);
-    M5.Lcd.setTextSize(1);
-    
-    // Title
-    M5.Lcd.setCursor(0, 0);
-    M5.Lcd.setTextSize(2);
-    M5.Lcd.println("Crestron Master");
-    
-    // Status line
-    M5.Lcd.setTextSize(1);
-    M5.Lcd.printf("Ping: %s  Heap: %d\n", 
-                  g_pingEnabled ? "ON " : "OFF", 
-                  esp_get_free_heap_size());
-    
-    // Communication stats
-    M5.Lcd.printf("TX: %d  RX: %d  ERR: %d\n",
-                  g_rs485.getTransmitCount(),
-                  g_rs485.getReceiveCount(),
-                  g_rs485.getErrorCount());
-    
-    // Ping statistics
-    uint32_t totalPings = g_slaveManager.getTotalPings();
-    uint32_t successPings = g_slaveManager.getSuccessfulPings();
-    uint32_t pingRate = totalPings > 0 ? (successPings * 100 / totalPings) : 0;
-    
-    M5.Lcd.printf("Pings: %d/%d (%d%%)\n", successPings, totalPings, pingRate);
-    
-    // Slave status
-    M5.Lcd.println("\nSlave Status:");
-    
-    const uint8_t slaves[] = {
-        SlaveDevices::IO_48_ADDRESS,
-        SlaveDevices::DIM8_ADDRESS,
-        SlaveDevices::DIMU8_ADDRESS
-    };
-    
-    const char* slaveNames[] = {"IO-48", "DIM8 ", "DIMU8"};
-    
-    for (int i = 0; i < 3; i++) {
-        auto state = g_slaveManager.getSlaveState(slaves[i]);
-        const char* stateStr = "OFFLINE";
-        uint16_t color = RED;
-        
-        switch (state) {
-            case SlaveManager::SlaveState::ONLINE:
-                stateStr = "ONLINE ";
-                color = GREEN;
-                break;
-            case SlaveManager::SlaveState::CONFIGURED:
-                stateStr = "CONFIG ";
-                color = BLUE;
-                break;
-            case SlaveManager::SlaveState::PING_SENT:
-                stateStr = "PING.. ";
-                color = YELLOW;
-                break;
-            case SlaveManager::SlaveState::CONFIGURING:
-                stateStr = "SETUP  ";
-                color = ORANGE;
-                break;
-            default:
-                break;
-        }
-        
-        M5.Lcd.setTextColor(color);
-        M5.Lcd.printf("0x%02X %s %s\n", slaves[i], slaveNames[i], stateStr);
-    }
-    
-    // Button labels
-    M5.Lcd.setTextColor(WHITE);
-    M5.Lcd.setCursor(0, 220);
-    M5.Lcd.printf("A:Ping  B:Dim1%s  C:Dim2%s",
-                  g_dimRequest1 ? "*" : " ",
-                  g_dimRequest2 ? "*" : " ");
-}
\ No newline at end of file
@@ -0,0 +1,401 @@
+#include "Benchmarks.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "CrestronFrameParser.h"
+#include "FramePool.h"
+#include "RS485Communication.h"
+#include "SlaveManager.h"
+#include "SlaveTable.h"
+
+namespace {
+    using BenchClock = std::chrono::steady_clock;
+
+    double elapsedNs(BenchClock::time_point start) {
+        return std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+    }
+
+    // ---- CrestronFrameParser ----
+
+    using Frame = CrestronFrameParser::Frame;
+    using Bytes = std::vector<uint8_t>;
+
+    // One line per frame, e.g. "m>s 05 len 3: 1d 00 ff"
+    std::string describe(const Frame& frame) {
+        char line[16 + 3 * CrestronFrameParser::MAX_PAYLOAD_LENGTH];
+        int offset = snprintf(line, sizeof(line), "%s %02x",
+                              frame.direction == CrestronFrameParser::Direction::MASTER_TO_SLAVE ? "m>s" : "s>m",
+                              frame.address);
+        if (frame.isPing) {
+            snprintf(line + offset, sizeof(line) - offset, " ping");
+        } else {
+            offset += snprintf(line + offset, sizeof(line) - offset, " len %u:", frame.length);
+            for (size_t i = 0; i < frame.length; i++) {
+                offset += snprintf(line + offset, sizeof(line) - offset, " %02x", frame.payload[i]);
+            }
+        }
+        return line;
+    }
+
+    // Feeds data in spans of at most chunk bytes, as the RX task does with
+    // whatever the UART delivered
+    void feedAll(CrestronFrameParser& parser, const Bytes& data, size_t chunk,
+                 std::vector<std::string>& frames) {
+        for (size_t start = 0; start < data.size(); start += chunk) {
+            size_t length = std::min(chunk, data.size() - start);
+            size_t consumed = 0;
+            while (consumed < length) {
+                consumed += parser.feed(&data[start + consumed], length - consumed);
+                if (parser.hasFrame()) frames.push_back(describe(parser.frame()));
+            }
+        }
+    }
+
+    Bytes concat(std::initializer_list<Bytes> parts) {
+        Bytes bytes;
+        for (const Bytes& part : parts) bytes.insert(bytes.end(), part.begin(), part.end());
+        return bytes;
+    }
+
+    // A poll and a command to 0x05 with their replies
+    const Bytes PING = {0x05, 0x00};
+    const Bytes PING_REPLY = {0x02, 0x00};
+    const Bytes DIM = {0x05, 0x08, 0x1D, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x01, 0xFF};
+    const Bytes INPUT_REPLY = {0x02, 0x03, 0x00, 0x01, 0x00};
+    const std::vector<std::string> EXPECTED = {
+        "m>s 05 ping",
+        "s>m 05 ping",
+        "m>s 05 len 8: 1d 00 00 00 00 ff 01 ff",
+        "s>m 05 len 3: 00 01 00",
+    };
+
+    struct Checks {
+        uint32_t run = 0;
+        uint32_t failed = 0;
+
+        void expect(bool condition, const char* name, const char* detail = "") {
+            run++;
+            if (!condition) {
+                failed++;
+                printf("FAIL parser: %s %s\n", name, detail);
+            }
+        }
+
+        void expectFrames(const std::vector<std::string>& frames, const char* name) {
+            bool match = frames == EXPECTED;
+            expect(match, name);
+            if (!match) {
+                for (const std::string& frame : frames) printf("     got  %s\n", frame.c_str());
+            }
+        }
+    };
+
+    void checkParser(Checks& checks) {
+        const Bytes stream = concat({PING, PING_REPLY, DIM, INPUT_REPLY});
+
+        {
+            // Back-to-back frames merged into one read
+            CrestronFrameParser parser;
+            std::vector<std::string> frames;
+            feedAll(parser, stream, stream.size(), frames);
+            checks.expectFrames(frames, "merged frames");
+            checks.expect(parser.getFrameCount() == EXPECTED.size() && parser.getSkippedByteCount() == 0,
+                          "merged frame counters");
+        }
+        {
+            // Every frame split across reads, down to one byte per read
+            CrestronFrameParser parser;
+            std::vector<std::string> frames;
+            feedAll(parser, stream, 1, frames);
+            checks.expectFrames(frames, "one byte per read");
+        }
+        for (size_t split = 1; split < stream.size(); split++) {
+            CrestronFrameParser parser;
+            std::vector<std::string> frames;
+            Bytes first(stream.begin(), stream.begin() + split);
+            Bytes second(stream.begin() + split, stream.end());
+            feedAll(parser, first, first.size(), frames);
+            feedAll(parser, second, second.size(), frames);
+            char name[32];
+            snprintf(name, sizeof(name), "split at byte %u", static_cast<unsigned>(split));
+            checks.expectFrames(frames, name);
+        }
+        {
+            // Idle fill and break NULs between frames are skipped
+            CrestronFrameParser parser;
+            std::vector<std::string> frames;
+            Bytes noisy = concat({{0xFF, 0xFF, 0x00}, PING, {0x00}, PING_REPLY, DIM, {0xFF}, INPUT_REPLY});
+            feedAll(parser, noisy, 3, frames);
+            checks.expectFrames(frames, "idle fill and breaks");
+            checks.expect(parser.getSkippedByteCount() == 5, "idle fill counted as skipped");
+        }
+        {
+            // Garbage that looks like the start of a frame is dropped at the
+            // next line break, after which decoding picks up again
+            CrestronFrameParser parser;
+            std::vector<std::string> frames;
+            feedAll(parser, {0x37, 0x41, 0x99, 0x12}, 4, frames);
+            checks.expect(frames.empty(), "no frame from garbage");
+            parser.reset();
+            feedAll(parser, stream, 5, frames);
+            checks.expectFrames(frames, "resync after garbage");
+            checks.expect(parser.getSkippedByteCount() == 4, "garbage counted as skipped");
+        }
+        {
+            // A length longer than what arrived: the truncated frame is
+            // discarded at the break and does not swallow the next frames
+            CrestronFrameParser parser;
+            std::vector<std::string> frames;
+            feedAll(parser, {0x05, 0x20, 0x1D, 0x00, 0x00}, 5, frames);
+            parser.reset();
+            feedAll(parser, stream, stream.size(), frames);
+            checks.expectFrames(frames, "truncated frame");
+            checks.expect(parser.getSkippedByteCount() == 5, "truncated frame counted as skipped");
+        }
+        {
+            // The longest length the format can express fits the buffer
+            CrestronFrameParser parser;
+            std::vector<std::string> frames;
+            Bytes longest = {0x05, 0xFF};
+            for (size_t i = 0; i < CrestronFrameParser::MAX_PAYLOAD_LENGTH; i++) {
+                longest.push_back(static_cast<uint8_t>(i));
+            }
+            feedAll(parser, concat({longest, PING_REPLY}), 64, frames);
+            checks.expect(frames.size() == 2 && parser.frame().address == 0x05,
+                          "255-byte payload then reply");
+        }
+    }
+
+    // Bus traffic in the proportions of a busy bus: every poll answered, a
+    // DIM frame every fourth cycle and an input report every eighth
+    Bytes buildTraffic(size_t minimumBytes) {
+        Bytes traffic;
+        for (uint32_t cycle = 0; traffic.size() < minimumBytes; cycle++) {
+            Bytes ping = PING;
+            ping[0] = static_cast<uint8_t>(0x03 + cycle % 32);
+            traffic.insert(traffic.end(), ping.begin(), ping.end());
+            if (cycle % 8 == 7) {
+                traffic.insert(traffic.end(), INPUT_REPLY.begin(), INPUT_REPLY.end());
+            } else {
+                traffic.insert(traffic.end(), PING_REPLY.begin(), PING_REPLY.end());
+            }
+            if (cycle % 4 == 3) {
+                traffic.insert(traffic.end(), DIM.begin(), DIM.end());
+            }
+        }
+        return traffic;
+    }
+
+    void benchParser() {
+        static const size_t chunks[] = {1, 8, 64, 4096};
+        constexpr size_t TRAFFIC_BYTES = 1 << 20;
+        constexpr uint32_t PASSES = 32;
+        const Bytes traffic = buildTraffic(TRAFFIC_BYTES);
+
+        printf("read bytes   MB/s   Mframes/s   ns/byte\n");
+        for (size_t chunk : chunks) {
+            CrestronFrameParser parser;
+            uint64_t payloadBytes = 0;
+            BenchClock::time_point start = BenchClock::now();
+            for (uint32_t pass = 0; pass < PASSES; pass++) {
+                for (size_t offset = 0; offset < traffic.size(); offset += chunk) {
+                    size_t length = std::min(chunk, traffic.size() - offset);
+                    size_t consumed = 0;
+                    while (consumed < length) {
+                        consumed += parser.feed(&traffic[offset + consumed], length - consumed);
+                        if (parser.hasFrame()) payloadBytes += parser.frame().length;
+                    }
+                }
+            }
+            double ns = elapsedNs(start);
+            double bytes = static_cast<double>(traffic.size()) * PASSES;
+            printf("%10u %6.0f %11.1f %9.2f\n", static_cast<unsigned>(chunk),
+                   bytes * 1000.0 / ns, parser.getFrameCount() * 1000.0 / ns, ns / bytes);
+            if (payloadBytes == 0) printf("     (no frames decoded)\n");
+        }
+    }
+
+    // ---- TX hand-off ----
+
+    // Submit to the TX task's pick-up, single-threaded so only the per-frame
+    // cost is measured: building the frame, handing it over and reading it
+    // back out as the UART write would
+    using Message = RS485Communication::Message;
+    constexpr size_t TX_DEPTH = CrestronProtocol::FRAME_POOL_SIZE;
+    constexpr uint32_t TX_FRAMES = 1000000;
+    volatile uint32_t g_txSink;
+
+    void fillFrame(uint8_t* data, size_t length, uint32_t frame) {
+        for (size_t i = 0; i < length; i++) data[i] = static_cast<uint8_t>(frame + i);
+    }
+
+    // The original design: the caller copies into a stack Message, takes
+    // m_txMutex and xQueueSend copies it again; the TX task copies it out
+    double benchQueueCopy(size_t length) {
+        QueueHandle_t queue = xQueueCreate(TX_DEPTH, sizeof(Message));
+        SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+        uint8_t source[CrestronProtocol::MAX_MESSAGE_LENGTH];
+        uint32_t sink = 0;
+
+        BenchClock::time_point start = BenchClock::now();
+        for (uint32_t frame = 0; frame < TX_FRAMES; frame++) {
+            fillFrame(source, length, frame);
+            Message message;
+            memcpy(message.data, source, length);
+            message.length = length;
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            xQueueSend(queue, &message, 0);
+            xSemaphoreGive(mutex);
+
+            Message out;
+            if (xQueueReceive(queue, &out, 0) != pdTRUE) continue;
+            sink += out.data[out.length - 1];
+        }
+        double ns = elapsedNs(start) / TX_FRAMES;
+        g_txSink = sink;
+        return ns;
+    }
+
+    // The same copies through a lock-free ring, to separate copying from locking
+    double benchRingCopy(size_t length) {
+        static SpscRing<Message, TX_DEPTH> ring;
+        uint8_t source[CrestronProtocol::MAX_MESSAGE_LENGTH];
+        uint32_t sink = 0;
+
+        BenchClock::time_point start = BenchClock::now();
+        for (uint32_t frame = 0; frame < TX_FRAMES; frame++) {
+            fillFrame(source, length, frame);
+            Message message;
+            memcpy(message.data, source, length);
+            message.length = length;
+            ring.push(message);
+
+            Message out;
+            if (!ring.pop(out)) continue;
+            sink += out.data[out.length - 1];
+        }
+        double ns = elapsedNs(start) / TX_FRAMES;
+        g_txSink = sink;
+        return ns;
+    }
+
+    // What RS485Communication does now: the frame is built in a pooled
+    // buffer and only its pointer moves through the lane ring
+    double benchPoolHandle(size_t length) {
+        static FramePool<Message, TX_DEPTH> pool;
+        static SpscRing<Message*, TX_DEPTH> lane;
+        uint32_t sink = 0;
+
+        BenchClock::time_point start = BenchClock::now();
+        for (uint32_t frame = 0; frame < TX_FRAMES; frame++) {
+            Message* message = pool.acquire();
+            fillFrame(message->data, length, frame);
+            message->length = length;
+            lane.push(message);
+
+            Message* out = nullptr;
+            if (!lane.pop(out)) continue;
+            sink += out->data[out->length - 1];
+            pool.release(out);
+        }
+        double ns = elapsedNs(start) / TX_FRAMES;
+        g_txSink = sink;
+        return ns;
+    }
+
+    // ---- SlaveTable ----
+
+    // One ping cycle's table work: pick the next slave round-robin, mark it
+    // polled, then find it again from the reply's address and update it
+    using SlaveInfo = SlaveManager::SlaveInfo;
+    constexpr uint32_t BENCH_CYCLES = 2000000;
+
+    double benchMap(uint32_t slaves) {
+        std::map<uint8_t, SlaveInfo> table;
+        for (uint32_t i = 0; i < slaves; i++) {
+            table[static_cast<uint8_t>(3 + i)] = SlaveInfo{};
+        }
+
+        uint32_t index = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (uint32_t cycle = 0; cycle < BENCH_CYCLES; cycle++) {
+            auto it = table.begin();
+            std::advance(it, index % table.size());
+            it->second.state = SlaveManager::SlaveState::PING_SENT;
+            index = (index + 1) % table.size();
+
+            auto reply = table.find(it->first);
+            reply->second.state = SlaveManager::SlaveState::ONLINE;
+            reply->second.lastTurnaroundUs = cycle;
+        }
+        return elapsedNs(start) / BENCH_CYCLES;
+    }
+
+    double benchTable(uint32_t slaves) {
+        static SlaveTable<SlaveInfo> table;
+        table.clear();
+        for (uint32_t i = 0; i < slaves; i++) {
+            table.insert(static_cast<uint8_t>(3 + i), SlaveInfo{});
+        }
+
+        BenchClock::time_point start = BenchClock::now();
+        for (uint32_t cycle = 0; cycle < BENCH_CYCLES; cycle++) {
+            uint8_t address = 0;
+            SlaveInfo* slave = table.next(address);
+            slave->state = SlaveManager::SlaveState::PING_SENT;
+
+            SlaveInfo* reply = table.find(address);
+            reply->state = SlaveManager::SlaveState::ONLINE;
+            reply->lastTurnaroundUs = cycle;
+        }
+        return elapsedNs(start) / BENCH_CYCLES;
+    }
+}
+
+namespace Benchmarks {
+    bool runParserSuite() {
+        Checks checks;
+        checkParser(checks);
+        printf("parser: %u of %u checks passed\n",
+               static_cast<unsigned>(checks.run - checks.failed), static_cast<unsigned>(checks.run));
+        benchParser();
+        return checks.failed == 0;
+    }
+
+    void runTxPathBench() {
+        // Ping, DIM frame, longest configuration frame
+        static const size_t lengths[] = {2, 10, 67};
+        printf("frame bytes   queue+copy ns   ring+copy ns   pool handle ns\n");
+        for (size_t length : lengths) {
+            printf("%11u   %13.1f   %12.1f   %14.1f\n", static_cast<unsigned>(length),
+                   benchQueueCopy(length), benchRingCopy(length), benchPoolHandle(length));
+        }
+        printf("(host timings; the queue column pays a pthread mutex where the ESP32 takes a critical section)\n");
+    }
+
+    void runSlaveTableBench() {
+        static const uint32_t sizes[] = {3, 8, 16, 32, 64, 128, 250};
+        printf("slaves   std::map ns/cycle   SlaveTable ns/cycle\n");
+        for (uint32_t slaves : sizes) {
+            printf("%6u   %17.1f   %19.1f\n", static_cast<unsigned>(slaves), benchMap(slaves), benchTable(slaves));
+        }
+    }
+
+    bool run() {
+        bool passed = runParserSuite();
+        printf("\n");
+        runTxPathBench();
+        printf("\n");
+        runSlaveTableBench();
+        return passed;
+    }
+}
@@ -0,0 +1,592 @@
+// FreeRTOS and esp_timer shim for the native (Linux) build
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/timers.h>
+#include <esp_timer.h>
+#include <NativeClock.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const Clock::time_point g_startTime = Clock::now();
+
+    // ---- Simulated time (see NativeClock.h) ----
+
+    constexpr int64_t NO_DEADLINE = INT64_MAX;
+
+    std::atomic<bool> g_virtual(false);
+    std::atomic<int64_t> g_virtualUs(1);    // esp_timer_get_time() never returns 0
+
+    // A thread blocked in virtualWait(); registered while it waits
+    struct VirtualWaiter {
+        std::mutex* mutex;
+        std::condition_variable* cv;
+        int64_t deadlineUs;
+        const std::function<bool()>* ready;
+    };
+
+    std::mutex g_clockMutex;
+    std::condition_variable g_clockCv;
+    std::vector<VirtualWaiter*> g_waiters;
+    int g_threads = 0;          // Counted threads
+    int g_blocked = 0;          // Counted threads in virtualWait()
+    thread_local bool t_counted = false;
+
+    void countThread() {
+        std::lock_guard<std::mutex> clock(g_clockMutex);
+        g_threads++;
+    }
+
+    void uncountThread() {
+        std::lock_guard<std::mutex> clock(g_clockMutex);
+        g_threads--;
+        g_clockCv.notify_one();
+    }
+
+    // Waits under lock until ready() or the simulated clock reaches
+    // deadlineUs. The waiter's own mutex is never held while g_clockMutex is
+    // taken, so the clock thread may take them in the other order.
+    template <typename Predicate>
+    bool virtualWait(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                     int64_t deadlineUs, Predicate ready) {
+        const std::function<bool()> check = [&ready] { return ready(); };
+        VirtualWaiter waiter = {lock.mutex(), &cv, deadlineUs, &check};
+        while (true) {
+            if (ready()) return true;
+            if (g_virtualUs.load() >= deadlineUs) return false;
+
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> clock(g_clockMutex);
+                g_waiters.push_back(&waiter);
+                if (t_counted && ++g_blocked == g_threads) g_clockCv.notify_one();
+            }
+            lock.lock();
+            while (!ready() && g_virtualUs.load() < deadlineUs) {
+                cv.wait(lock);
+            }
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> clock(g_clockMutex);
+                g_waiters.erase(std::find(g_waiters.begin(), g_waiters.end(), &waiter));
+                if (t_counted) g_blocked--;
+            }
+            // Whatever woke us may have been taken meanwhile; look again
+            lock.lock();
+        }
+    }
+
+    // Moves the clock to the earliest deadline once every counted thread is
+    // blocked and none of them is about to wake
+    void runVirtualClock() {
+        std::unique_lock<std::mutex> clock(g_clockMutex);
+        while (true) {
+            g_clockCv.wait_for(clock, std::chrono::microseconds(100));
+            if (g_threads == 0 || g_blocked < g_threads) continue;
+
+            const int64_t now = g_virtualUs.load();
+            int64_t nextUs = NO_DEADLINE;
+            bool runnable = false;
+            for (VirtualWaiter* waiter : g_waiters) {
+                std::lock_guard<std::mutex> lock(*waiter->mutex);
+                if (waiter->deadlineUs <= now || (*waiter->ready)()) {
+                    // Notified, and will run as soon as it wakes
+                    runnable = true;
+                    break;
+                }
+                nextUs = std::min(nextUs, waiter->deadlineUs);
+            }
+            if (runnable || nextUs == NO_DEADLINE) continue;
+
+            // Set before the notify, under each waiter's mutex, so a waiter
+            // between its check and its wait cannot miss it
+            g_virtualUs.store(nextUs);
+            for (VirtualWaiter* waiter : g_waiters) {
+                if (waiter->deadlineUs <= nextUs) {
+                    std::lock_guard<std::mutex> lock(*waiter->mutex);
+                    waiter->cv->notify_all();
+                }
+            }
+        }
+    }
+
+    // portMAX_DELAY waits forever; anything else is a deadline in ticks (ms)
+    template <typename Predicate>
+    bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                 TickType_t ticks, Predicate ready) {
+        if (g_virtual) {
+            return virtualWait(cv, lock, ticks == portMAX_DELAY ? NO_DEADLINE
+                                                                : g_virtualUs.load() + static_cast<int64_t>(ticks) * 1000,
+                               ready);
+        }
+        if (ticks == portMAX_DELAY) {
+            cv.wait(lock, ready);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+    }
+
+    // Simulated sleep until deadlineUs
+    void virtualSleepUntil(int64_t deadlineUs) {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::unique_lock<std::mutex> lock(mutex);
+        virtualWait(cv, lock, deadlineUs, [] { return false; });
+    }
+}
+
+void NativeClock::useVirtualTime() {
+    g_virtual = true;
+    std::thread(runVirtualClock).detach();
+}
+
+bool NativeClock::isVirtual() {
+    return g_virtual;
+}
+
+void NativeClock::attachThread() {
+    if (!g_virtual || t_counted) return;
+    countThread();
+    t_counted = true;
+}
+
+// ---------------------------------------------------------------------------
+// Tasks and notifications
+
+struct ShimTask {
+    TaskFunction_t function;
+    void* parameter;
+    pthread_t thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifyValue = 0;
+};
+
+static thread_local ShimTask* t_currentTask = nullptr;
+
+static void* taskEntry(void* argument) {
+    ShimTask* task = static_cast<ShimTask*>(argument);
+    t_currentTask = task;
+    // Counted by the creator already, so the clock cannot run ahead of the
+    // task's first wait
+    t_counted = g_virtual;
+    task->function(task->parameter);
+    if (t_counted) uncountThread();
+    return nullptr;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t,
+                                   void* parameter, UBaseType_t, TaskHandle_t* handle,
+                                   BaseType_t) {
+    ShimTask* task = new ShimTask();
+    task->function = function;
+    task->parameter = parameter;
+
+    if (g_virtual) countThread();
+    if (pthread_create(&task->thread, nullptr, taskEntry, task) != 0) {
+        if (g_virtual) uncountThread();
+        delete task;
+        return pdFAIL;
+    }
+
+    pthread_detach(task->thread);
+    if (name) {
+        char threadName[16];
+        strncpy(threadName, name, sizeof(threadName) - 1);
+        threadName[sizeof(threadName) - 1] = '\0';
+        pthread_setname_np(task->thread, threadName);
+    }
+
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                               void* parameter, UBaseType_t priority, StackType_t* stack,
+                               StaticTask_t* taskBuffer) {
+    return xTaskCreateStaticPinnedToCore(function, name, stackDepth, parameter, priority,
+                                         stack, taskBuffer, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                           void* parameter, UBaseType_t priority, StackType_t*,
+                                           StaticTask_t*, BaseType_t core) {
+    // The thread brings its own stack; the caller's buffer goes unused
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, &handle, core) != pdPASS) {
+        return nullptr;
+    }
+    return handle;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (!task || task == t_currentTask) {
+        if (t_counted) uncountThread();
+        pthread_exit(nullptr);
+    }
+
+    // A thread cannot be stopped safely from outside (cancelling it inside a
+    // condition wait terminates the process), so other tasks keep running.
+    // The native program therefore leaves with _exit() instead of tearing
+    // the stack down.
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (g_virtual) {
+        virtualSleepUntil(g_virtualUs.load() + static_cast<int64_t>(ticks) * 1000);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment) {
+    *previousWakeTime += increment;
+    if (g_virtual) {
+        virtualSleepUntil(static_cast<int64_t>(*previousWakeTime) * 1000);
+        return;
+    }
+    std::this_thread::sleep_until(g_startTime + std::chrono::milliseconds(*previousWakeTime));
+}
+
+TickType_t xTaskGetTickCount() {
+    if (g_virtual) {
+        return static_cast<TickType_t>(g_virtualUs.load() / 1000);
+    }
+    return static_cast<TickType_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - g_startTime).count());
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    // Threads not created through the shim (main) get a handle on first use
+    if (!t_currentTask) {
+        t_currentTask = new ShimTask();
+        t_currentTask->thread = pthread_self();
+    }
+    return t_currentTask;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifyValue++;
+    }
+    task->cv.notify_one();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+    ShimTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+
+    waitFor(task->cv, lock, ticksToWait, [task] { return task->notifyValue > 0; });
+
+    uint32_t value = task->notifyValue;
+    if (value > 0) {
+        task->notifyValue = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+// ---------------------------------------------------------------------------
+// Queues and mutexes
+
+struct ShimQueue {
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::vector<uint8_t> storage;
+    size_t itemSize;
+    size_t capacity;
+    size_t head = 0;
+    size_t count = 0;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    ShimQueue* queue = new ShimQueue();
+    queue->itemSize = itemSize;
+    queue->capacity = length;
+    queue->storage.resize(static_cast<size_t>(length) * (itemSize > 0 ? itemSize : 1));
+    return queue;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize, uint8_t*, StaticQueue_t*) {
+    return xQueueCreate(length, itemSize);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitFor(queue->notFull, lock, ticksToWait, [queue] { return queue->count < queue->capacity; })) {
+        return pdFALSE;
+    }
+
+    size_t slot = (queue->head + queue->count) % queue->capacity;
+    if (queue->itemSize > 0) {
+        memcpy(&queue->storage[slot * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+    lock.unlock();
+    queue->notEmpty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitFor(queue->notEmpty, lock, ticksToWait, [queue] { return queue->count > 0; })) {
+        return pdFALSE;
+    }
+
+    if (queue->itemSize > 0 && item) {
+        memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    }
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    lock.unlock();
+    queue->notFull.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->head = 0;
+        queue->count = 0;
+    }
+    queue->notFull.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return static_cast<UBaseType_t>(queue->count);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    // A mutex is a one-slot queue that starts full: take = receive, give = send
+    SemaphoreHandle_t semaphore = xQueueCreate(1, 0);
+    xQueueSend(semaphore, nullptr, 0);
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t*) {
+    return xSemaphoreCreateMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    return xQueueReceive(semaphore, nullptr, ticksToWait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return xQueueSend(semaphore, nullptr, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    vQueueDelete(semaphore);
+}
+
+// ---------------------------------------------------------------------------
+// Software timers and esp_timer: a worker thread per timer waits for its
+// next expiry and runs the callback on that thread
+
+struct ShimTimerBase {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+    Clock::time_point expiry;
+    int64_t expiryUs = 0;           // Simulated time
+    uint32_t generation = 0;        // Bumped by every arm and disarm
+    bool armed = false;
+    bool exiting = false;
+
+    template <typename Fire>
+    void run(Fire fire) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (g_virtual) {
+            t_counted = true;
+            while (!exiting) {
+                const uint32_t seen = generation;
+                auto changed = [this, seen] { return exiting || generation != seen; };
+                if (!virtualWait(cv, lock, armed ? expiryUs : NO_DEADLINE, changed) && armed) {
+                    armed = false;
+                    fire(lock);
+                }
+            }
+            lock.unlock();
+            uncountThread();
+            return;
+        }
+        while (!exiting) {
+            if (!armed) {
+                cv.wait(lock);
+                continue;
+            }
+            if (cv.wait_until(lock, expiry) == std::cv_status::timeout && armed && Clock::now() >= expiry) {
+                armed = false;
+                fire(lock);
+            }
+        }
+    }
+
+    // Starts in timeoutUs, on whichever clock the shim runs
+    void arm(uint64_t timeoutUs) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (g_virtual) {
+                expiryUs = g_virtualUs.load() + static_cast<int64_t>(timeoutUs);
+            } else {
+                expiry = Clock::now() + std::chrono::microseconds(timeoutUs);
+            }
+            armed = true;
+            generation++;
+        }
+        cv.notify_one();
+    }
+
+    void disarm() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            armed = false;
+            generation++;
+        }
+        cv.notify_one();
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            exiting = true;
+        }
+        cv.notify_one();
+        if (worker.joinable()) {
+            if (worker.get_id() == std::this_thread::get_id()) {
+                worker.detach();
+            } else {
+                worker.join();
+            }
+        }
+    }
+};
+
+struct ShimTimer : ShimTimerBase {
+    TickType_t period;
+    bool autoReload;
+    void* timerId;
+    TimerCallbackFunction_t callback;
+};
+
+TimerHandle_t xTimerCreate(const char*, TickType_t period, UBaseType_t autoReload,
+                           void* timerId, TimerCallbackFunction_t callback) {
+    ShimTimer* timer = new ShimTimer();
+    timer->period = period;
+    timer->autoReload = autoReload != pdFALSE;
+    timer->timerId = timerId;
+    timer->callback = callback;
+
+    if (g_virtual) countThread();
+    timer->worker = std::thread([timer] {
+        timer->run([timer](std::unique_lock<std::mutex>& lock) {
+            if (timer->autoReload) {
+                // Fixed rate, like the FreeRTOS timer service
+                timer->expiry += std::chrono::milliseconds(timer->period);
+                timer->expiryUs += static_cast<int64_t>(timer->period) * 1000;
+                timer->armed = true;
+            }
+            lock.unlock();
+            timer->callback(timer);
+            lock.lock();
+        });
+    });
+    return timer;
+}
+
+TimerHandle_t xTimerCreateStatic(const char* name, TickType_t period, UBaseType_t autoReload,
+                                 void* timerId, TimerCallbackFunction_t callback, StaticTimer_t*) {
+    return xTimerCreate(name, period, autoReload, timerId, callback);
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t) {
+    timer->arm(static_cast<uint64_t>(timer->period) * 1000);
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t) {
+    timer->disarm();
+    return pdPASS;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t) {
+    timer->shutdown();
+    delete timer;
+    return pdPASS;
+}
+
+void* pvTimerGetTimerID(TimerHandle_t timer) {
+    return timer->timerId;
+}
+
+struct ShimEspTimer : ShimTimerBase {
+    esp_timer_cb_t callback;
+    void* arg;
+};
+
+int64_t esp_timer_get_time() {
+    if (g_virtual) {
+        return g_virtualUs.load();
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_startTime).count() + 1;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    if (!args || !args->callback || !handle) return ESP_FAIL;
+
+    ShimEspTimer* timer = new ShimEspTimer();
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    if (g_virtual) countThread();
+    timer->worker = std::thread([timer] {
+        timer->run([timer](std::unique_lock<std::mutex>& lock) {
+            lock.unlock();
+            timer->callback(timer->arg);
+            lock.lock();
+        });
+    });
+
+    *handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    timer->arm(timeoutUs);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->disarm();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    timer->shutdown();
+    delete timer;
+    return ESP_OK;
+}
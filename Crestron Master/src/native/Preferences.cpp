@@ -0,0 +1,75 @@
+// In-memory Preferences for the native build
+#include <Preferences.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+    using Blob = std::vector<uint8_t>;
+
+    std::mutex g_mutex;
+    std::map<std::string, std::map<std::string, Blob>> g_namespaces;
+
+    Blob* findBlob(const char* name, const char* key) {
+        auto space = g_namespaces.find(name);
+        if (space == g_namespaces.end()) return nullptr;
+        auto entry = space->second.find(key);
+        return entry == space->second.end() ? nullptr : &entry->second;
+    }
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    // As on NVS, a read-only open of a namespace that was never written fails
+    if (readOnly && g_namespaces.find(name) == g_namespaces.end()) {
+        return false;
+    }
+    g_namespaces[name];
+    m_namespace = name;
+    m_readOnly = readOnly;
+    return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!m_namespace || m_readOnly) return 0;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    g_namespaces[m_namespace][key] = Blob(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    if (!m_namespace) return 0;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Blob* blob = findBlob(m_namespace, key);
+    if (!blob || blob->size() > maxLength) return 0;
+
+    std::copy(blob->begin(), blob->end(), static_cast<uint8_t*>(buffer));
+    return blob->size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!m_namespace) return 0;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Blob* blob = findBlob(m_namespace, key);
+    return blob ? blob->size() : 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!m_namespace) return false;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return findBlob(m_namespace, key) != nullptr;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!m_namespace || m_readOnly) return false;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_namespaces[m_namespace].erase(key) > 0;
+}
@@ -0,0 +1,252 @@
+#include "PtyTransport.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+
+static const char* TAG = "PtyTransport";
+
+PtyTransport::PtyTransport(const char* devicePath)
+    : m_devicePath(devicePath)
+    , m_fd(-1)
+    , m_peerFd(-1)
+    , m_baudRate(0)
+    , m_characterTimeUs(0)
+    , m_idleTimeoutUs(0)
+    , m_running(false)
+    , m_txDoneUs(0)
+{
+    m_peerPath[0] = '\0';
+}
+
+PtyTransport::~PtyTransport() {
+    close();
+}
+
+bool PtyTransport::open(const BusSettings& settings) {
+    m_baudRate = settings.baudRate;
+    // Start bit + 8 data bits + 2 stop bits, as configured in RS485Config
+    m_characterTimeUs = (11 * 1000000UL + m_baudRate - 1) / m_baudRate;
+    m_idleTimeoutUs = settings.rxIdleTimeoutSymbols * m_characterTimeUs;
+
+    if (m_devicePath) {
+        m_fd = ::open(m_devicePath, O_RDWR | O_NOCTTY);
+        if (m_fd < 0) {
+            ESP_LOGE(TAG, "Cannot open %s: %s", m_devicePath, strerror(errno));
+            return false;
+        }
+        strncpy(m_peerPath, m_devicePath, sizeof(m_peerPath) - 1);
+        m_peerPath[sizeof(m_peerPath) - 1] = '\0';
+    } else {
+        m_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (m_fd < 0 || grantpt(m_fd) != 0 || unlockpt(m_fd) != 0 ||
+            ptsname_r(m_fd, m_peerPath, sizeof(m_peerPath)) != 0) {
+            ESP_LOGE(TAG, "Cannot create pseudo-terminal: %s", strerror(errno));
+            close();
+            return false;
+        }
+
+        // Raw mode is a property of the slave side; keep one descriptor open
+        m_peerFd = ::open(m_peerPath, O_RDWR | O_NOCTTY);
+        if (m_peerFd < 0 || !configureLine(m_peerFd)) {
+            ESP_LOGE(TAG, "Cannot configure %s", m_peerPath);
+            close();
+            return false;
+        }
+    }
+
+    if (!configureLine(m_fd)) {
+        ESP_LOGE(TAG, "Cannot configure line settings");
+        close();
+        return false;
+    }
+
+    m_running = true;
+    m_reader = std::thread(&PtyTransport::readerLoop, this);
+
+    ESP_LOGI(TAG, "%s bus on %s, %u baud", settings.name, m_peerPath, static_cast<unsigned>(m_baudRate));
+    return true;
+}
+
+void PtyTransport::close() {
+    m_running = false;
+    if (m_reader.joinable()) {
+        m_reader.join();
+    }
+
+    if (m_peerFd >= 0) {
+        ::close(m_peerFd);
+        m_peerFd = -1;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool PtyTransport::configureLine(int fd) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        return false;
+    }
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD | CSTOPB;
+    tio.c_cflag &= ~(PARENB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+
+    // Baud rate only matters on a real adapter; a pty ignores it
+    speed_t speed = m_baudRate == 38400 ? B38400 : m_baudRate == 19200 ? B19200 :
+                    m_baudRate == 57600 ? B57600 : B115200;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+void PtyTransport::readerLoop() {
+    uint8_t buffer[256];
+    size_t pendingBytes = 0;    // Received since the last DATA event
+
+    while (m_running) {
+        // While a frame is open, wait only as long as the idle gap that ends it
+        struct timespec timeout;
+        if (pendingBytes > 0) {
+            timeout.tv_sec = 0;
+            timeout.tv_nsec = static_cast<long>(m_idleTimeoutUs) * 1000;
+        } else {
+            timeout.tv_sec = 0;
+            timeout.tv_nsec = 50 * 1000 * 1000;     // Re-check m_running
+        }
+
+        struct pollfd pfd = {m_fd, POLLIN, 0};
+        int ready = ppoll(&pfd, 1, &timeout, nullptr);
+
+        if (ready == 0) {
+            if (pendingBytes > 0) {
+                pushEvent({EventType::DATA, pendingBytes, true});
+                pendingBytes = 0;
+            }
+            continue;
+        }
+
+        if (ready < 0 || !(pfd.revents & POLLIN)) {
+            // No peer attached yet (EIO on a pty) or interrupted; back off
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        ssize_t count = ::read(m_fd, buffer, sizeof(buffer));
+        if (count <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        bool overflow = false;
+        {
+            std::lock_guard<std::mutex> lock(m_rxMutex);
+            if (m_rxBytes.size() + count > RX_BUFFER_SIZE) {
+                overflow = true;
+            } else {
+                m_rxBytes.insert(m_rxBytes.end(), buffer, buffer + count);
+            }
+        }
+
+        if (overflow) {
+            pushEvent({EventType::BUFFER_FULL, 0, false});
+            pendingBytes = 0;
+            continue;
+        }
+
+        pendingBytes += count;
+        if (pendingBytes >= RX_FULL_THRESHOLD) {
+            pushEvent({EventType::DATA, pendingBytes, false});
+            pendingBytes = 0;
+        }
+    }
+}
+
+void PtyTransport::pushEvent(const Event& event) {
+    {
+        std::lock_guard<std::mutex> lock(m_rxMutex);
+        m_events.push_back(event);
+    }
+    m_rxCv.notify_one();
+}
+
+bool PtyTransport::waitEvent(Event& event, TickType_t timeout) {
+    std::unique_lock<std::mutex> lock(m_rxMutex);
+    auto ready = [this] { return !m_events.empty(); };
+
+    if (timeout == portMAX_DELAY) {
+        m_rxCv.wait(lock, ready);
+    } else if (!m_rxCv.wait_for(lock, std::chrono::milliseconds(timeout), ready)) {
+        return false;
+    }
+
+    event = m_events.front();
+    m_events.pop_front();
+    return true;
+}
+
+int PtyTransport::read(uint8_t* buffer, size_t length) {
+    std::lock_guard<std::mutex> lock(m_rxMutex);
+    size_t count = length < m_rxBytes.size() ? length : m_rxBytes.size();
+    for (size_t i = 0; i < count; i++) {
+        buffer[i] = m_rxBytes.front();
+        m_rxBytes.pop_front();
+    }
+    return static_cast<int>(count);
+}
+
+void PtyTransport::flushInput() {
+    std::lock_guard<std::mutex> lock(m_rxMutex);
+    m_rxBytes.clear();
+}
+
+void PtyTransport::discardInput() {
+    std::lock_guard<std::mutex> lock(m_rxMutex);
+    m_rxBytes.clear();
+    m_events.clear();
+}
+
+int PtyTransport::write(const uint8_t* data, size_t length) {
+    return writeWithBreak(data, length, 0);
+}
+
+int PtyTransport::writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) {
+    ssize_t written = ::write(m_fd, data, length);
+    if (written < 0) {
+        return -1;
+    }
+
+    // The frame starts once the previous one has left, like the UART FIFO
+    std::lock_guard<std::mutex> lock(m_txMutex);
+    int64_t now = esp_timer_get_time();
+    int64_t start = m_txDoneUs > now ? m_txDoneUs : now;
+    m_txDoneUs = start + static_cast<int64_t>(written) * m_characterTimeUs +
+                 static_cast<int64_t>(breakBits) * 1000000LL / m_baudRate;
+    return static_cast<int>(written);
+}
+
+bool PtyTransport::waitTxDone(TickType_t timeout) {
+    int64_t doneUs;
+    {
+        std::lock_guard<std::mutex> lock(m_txMutex);
+        doneUs = m_txDoneUs;
+    }
+
+    int64_t waitUs = doneUs - esp_timer_get_time();
+    if (waitUs <= 0) return true;
+    if (timeout != portMAX_DELAY && waitUs > static_cast<int64_t>(timeout) * 1000) return false;
+
+    std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+    return true;
+}
@@ -0,0 +1,279 @@
+#include "ReplayTransport.h"
+#include <esp_log.h>
+#include <stdio.h>
+#include "BusCapture.h"
+#include "config.h"
+
+static const char* TAG = "ReplayTransport";
+
+namespace {
+    uint32_t readU32(const uint8_t* bytes) {
+        return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+               static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+    }
+
+    // [address] [0x00] from the master; address 0x00 is the NUL before a break
+    bool isPing(const uint8_t* data, size_t length) {
+        return length == 2 && data[1] == CrestronProtocol::PING_COMMAND &&
+               data[0] != 0x00 && data[0] != CrestronProtocol::TO_MASTER_PREFIX;
+    }
+}
+
+ReplayTransport::ReplayTransport()
+    : m_baudRate(0)
+    , m_recordCount(0)
+    , m_spanUs(0)
+    , m_exchangeCount(0)
+    , m_unattributed(0)
+    , m_characterTimeUs(0)
+    , m_remaining(0)
+    , m_exhausted(false)
+    , m_txDoneUs(0)
+    , m_events(nullptr)
+    , m_txDone(nullptr)
+    , m_rxTimer(nullptr)
+    , m_txDoneTimer(nullptr)
+{
+}
+
+ReplayTransport::~ReplayTransport() {
+    close();
+}
+
+bool ReplayTransport::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "replay: cannot open %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + count);
+    }
+    fclose(file);
+
+    if (bytes.size() < BusCapture::FILE_HEADER_SIZE || readU32(&bytes[0]) != BusCapture::FILE_MAGIC ||
+        bytes[4] != BusCapture::FORMAT_VERSION ||
+        readU32(&bytes[16]) != bytes.size() - BusCapture::FILE_HEADER_SIZE) {
+        fprintf(stderr, "replay: %s is not a version %u capture\n", path,
+                static_cast<unsigned>(BusCapture::FORMAT_VERSION));
+        return false;
+    }
+    m_baudRate = readU32(&bytes[8]);
+    m_recordCount = readU32(&bytes[12]);
+
+    // Records: u32 timestamp, u8 flags, u8 length, data
+    constexpr size_t RECORD_HEADER_SIZE = 6;
+    std::map<uint8_t, std::deque<Exchange>> exchanges;
+    Exchange* current = nullptr;
+    uint32_t pingUs = 0, firstUs = 0, lastUs = 0;
+    uint32_t records = 0;
+    for (size_t offset = BusCapture::FILE_HEADER_SIZE; offset < bytes.size(); records++) {
+        if (bytes.size() - offset < RECORD_HEADER_SIZE ||
+            bytes.size() - offset - RECORD_HEADER_SIZE < bytes[offset + 5]) {
+            fprintf(stderr, "replay: %s ends inside record %u\n", path, static_cast<unsigned>(records));
+            return false;
+        }
+        const uint32_t timestampUs = readU32(&bytes[offset]);
+        const uint8_t flags = bytes[offset + 4];
+        const uint8_t* data = &bytes[offset + RECORD_HEADER_SIZE];
+        const size_t length = bytes[offset + 5];
+        offset += RECORD_HEADER_SIZE + length;
+
+        if (records == 0) firstUs = timestampUs;
+        lastUs = timestampUs;
+
+        if (!(flags & BusCapture::FLAG_RX)) {
+            // A new transmission ends the previous exchange
+            current = nullptr;
+            if (isPing(data, length)) {
+                exchanges[data[0]].emplace_back();
+                current = &exchanges[data[0]].back();
+                pingUs = timestampUs;
+                m_exchangeCount++;
+            }
+        } else if (current) {
+            // Timestamps are the low 32 bits, so the difference survives a wrap
+            current->push_back({timestampUs - pingUs, std::vector<uint8_t>(data, data + length)});
+        } else {
+            m_unattributed++;
+        }
+    }
+
+    if (records != m_recordCount) {
+        fprintf(stderr, "replay: %s holds %u records, its header says %u\n", path,
+                static_cast<unsigned>(records), static_cast<unsigned>(m_recordCount));
+        return false;
+    }
+
+    m_spanUs = lastUs - firstUs;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exchanges.swap(exchanges);
+    m_remaining = m_exchangeCount;
+    m_exhausted = false;
+    return true;
+}
+
+size_t ReplayTransport::getRemainingExchanges() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_remaining;
+}
+
+bool ReplayTransport::isExhausted() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_exhausted;
+}
+
+std::vector<ReplayTransport::LogEntry> ReplayTransport::getLog() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_log;
+}
+
+bool ReplayTransport::open(const BusSettings& settings) {
+    // Start bit + 8 data bits + 2 stop bits, as configured in RS485Config
+    m_characterTimeUs = (11 * 1000000UL + settings.baudRate - 1) / settings.baudRate;
+    if (m_baudRate != 0 && m_baudRate != settings.baudRate) {
+        ESP_LOGW(TAG, "Capture was taken at %u baud, replaying at %u", static_cast<unsigned>(m_baudRate),
+                 static_cast<unsigned>(settings.baudRate));
+    }
+
+    m_events = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(Event));
+    m_txDone = xQueueCreate(1, 0);
+    const esp_timer_create_args_t rxArgs = {rxTimerCallback, this, ESP_TIMER_TASK, "replay_rx", false};
+    const esp_timer_create_args_t txArgs = {txDoneTimerCallback, this, ESP_TIMER_TASK, "replay_tx", false};
+    if (!m_events || !m_txDone || esp_timer_create(&rxArgs, &m_rxTimer) != ESP_OK ||
+        esp_timer_create(&txArgs, &m_txDoneTimer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create replay queues and timers");
+        close();
+        return false;
+    }
+
+    ESP_LOGI(TAG, "%s bus replaying %u exchanges", settings.name, static_cast<unsigned>(m_exchangeCount));
+    return true;
+}
+
+void ReplayTransport::close() {
+    if (m_rxTimer) {
+        esp_timer_stop(m_rxTimer);
+        esp_timer_delete(m_rxTimer);
+        m_rxTimer = nullptr;
+    }
+    if (m_txDoneTimer) {
+        esp_timer_stop(m_txDoneTimer);
+        esp_timer_delete(m_txDoneTimer);
+        m_txDoneTimer = nullptr;
+    }
+    if (m_events) {
+        vQueueDelete(m_events);
+        m_events = nullptr;
+    }
+    if (m_txDone) {
+        vQueueDelete(m_txDone);
+        m_txDone = nullptr;
+    }
+}
+
+bool ReplayTransport::waitEvent(Event& event, TickType_t timeout) {
+    return xQueueReceive(m_events, &event, timeout) == pdTRUE;
+}
+
+int ReplayTransport::read(uint8_t* buffer, size_t length) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    while (count < length && !m_rxBytes.empty()) {
+        buffer[count++] = m_rxBytes.front();
+        m_rxBytes.pop_front();
+    }
+    return static_cast<int>(count);
+}
+
+void ReplayTransport::flushInput() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rxBytes.clear();
+}
+
+void ReplayTransport::discardInput() {
+    flushInput();
+    xQueueReset(m_events);
+}
+
+int ReplayTransport::write(const uint8_t* data, size_t length) {
+    return writeWithBreak(data, length, 0);
+}
+
+int ReplayTransport::writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int64_t now = esp_timer_get_time();
+    m_log.push_back({now, false, breakBits > 0, std::vector<uint8_t>(data, data + length)});
+
+    // The frame starts once the previous one has left, like the UART FIFO
+    int64_t start = m_txDoneUs > now ? m_txDoneUs : now;
+    m_txDoneUs = start + static_cast<int64_t>(length) * m_characterTimeUs +
+                 static_cast<int64_t>(breakBits) * m_characterTimeUs / 11;
+
+    if (isPing(data, length)) {
+        auto exchanges = m_exchanges.find(data[0]);
+        if (exchanges != m_exchanges.end() && exchanges->second.empty()) {
+            m_exhausted = true;
+        } else if (exchanges != m_exchanges.end()) {
+            for (Reply& reply : exchanges->second.front()) {
+                m_pending.emplace(now + reply.delayUs, std::move(reply.data));
+            }
+            exchanges->second.pop_front();
+            m_remaining--;
+            armRxTimer(now);
+        }
+    }
+    return static_cast<int>(length);
+}
+
+bool ReplayTransport::waitTxDone(TickType_t timeout) {
+    int64_t doneUs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        doneUs = m_txDoneUs;
+    }
+
+    int64_t waitUs = doneUs - esp_timer_get_time();
+    if (waitUs <= 0) return true;
+    if (timeout != portMAX_DELAY && waitUs > static_cast<int64_t>(timeout) * 1000) return false;
+
+    esp_timer_start_once(m_txDoneTimer, static_cast<uint64_t>(waitUs));
+    return xQueueReceive(m_txDone, nullptr, timeout) == pdTRUE;
+}
+
+void ReplayTransport::rxTimerCallback(void* arg) {
+    static_cast<ReplayTransport*>(arg)->deliverDue();
+}
+
+void ReplayTransport::txDoneTimerCallback(void* arg) {
+    xQueueSend(static_cast<ReplayTransport*>(arg)->m_txDone, nullptr, 0);
+}
+
+void ReplayTransport::deliverDue() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int64_t now = esp_timer_get_time();
+    while (!m_pending.empty() && m_pending.begin()->first <= now) {
+        std::vector<uint8_t>& data = m_pending.begin()->second;
+        m_log.push_back({now, true, false, data});
+        m_rxBytes.insert(m_rxBytes.end(), data.begin(), data.end());
+
+        // One frame per event, delimited by the idle gap as the UART does
+        Event event = {EventType::DATA, data.size(), true};
+        if (xQueueSend(m_events, &event, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "Event queue full, dropping a replayed frame");
+            m_rxBytes.resize(m_rxBytes.size() - data.size());
+        }
+        m_pending.erase(m_pending.begin());
+    }
+    armRxTimer(now);
+}
+
+void ReplayTransport::armRxTimer(int64_t now) {
+    // Caller holds m_mutex
+    if (m_pending.empty()) return;
+    int64_t waitUs = m_pending.begin()->first - now;
+    esp_timer_start_once(m_rxTimer, waitUs > 0 ? static_cast<uint64_t>(waitUs) : 1);
+}
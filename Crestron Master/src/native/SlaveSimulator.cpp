@@ -0,0 +1,185 @@
+#include "SlaveSimulator.h"
+#include "config.h"
+#include "InboundDecoder.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+
+static const char* TAG = "SlaveSimulator";
+
+SlaveSimulator::SlaveSimulator()
+    : m_fd(-1)
+    , m_options{0x03, 1, RS485Config::BAUD_RATE, 500, 0, false, 0, 0}
+    , m_running(false)
+    , m_pingCount(0)
+    , m_replyCount(0)
+    , m_commandCount(0)
+    , m_configuredCount(0)
+    , m_inputStartUs(0)
+    , m_inputCount(0)
+    , m_reportedInputCount(0)
+{
+    memset(m_configRequested, 0, sizeof(m_configRequested));
+    memset(m_inputs, 0, sizeof(m_inputs));
+    for (std::atomic<int64_t>& time : m_reportedInputUs) {
+        time = 0;
+    }
+}
+
+SlaveSimulator::~SlaveSimulator() {
+    stop();
+}
+
+bool SlaveSimulator::start(const char* path, const Options& options) {
+    m_options = options;
+
+    m_fd = ::open(path, O_RDWR | O_NOCTTY);
+    if (m_fd < 0) {
+        ESP_LOGE(TAG, "Cannot open %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    struct termios tio;
+    if (tcgetattr(m_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(m_fd, TCSANOW, &tio);
+    }
+
+    m_inputStartUs = esp_timer_get_time();
+    m_running = true;
+    m_thread = std::thread(&SlaveSimulator::run, this);
+
+    ESP_LOGI(TAG, "Simulating %u slaves from 0x%02X, %u us turnaround, %u%% dropped",
+             m_options.slaveCount, m_options.firstAddress,
+             static_cast<unsigned>(m_options.turnaroundUs), m_options.dropPercent);
+    return true;
+}
+
+void SlaveSimulator::stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void SlaveSimulator::run() {
+    uint8_t buffer[256];
+
+    while (m_running) {
+        struct pollfd pfd = {m_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0 || !(pfd.revents & POLLIN)) {
+            continue;
+        }
+
+        ssize_t count = ::read(m_fd, buffer, sizeof(buffer));
+        if (count <= 0) {
+            continue;
+        }
+
+        const uint8_t* data = buffer;
+        size_t remaining = static_cast<size_t>(count);
+        while (remaining > 0) {
+            size_t consumed = m_parser.feed(data, remaining);
+            data += consumed;
+            remaining -= consumed;
+            if (m_parser.hasFrame()) {
+                handleFrame(m_parser.frame());
+            }
+        }
+    }
+}
+
+void SlaveSimulator::handleFrame(const CrestronFrameParser::Frame& frame) {
+    if (frame.direction != CrestronFrameParser::Direction::MASTER_TO_SLAVE ||
+        !isSimulated(frame.address)) {
+        return;
+    }
+
+    if (!frame.isPing) {
+        m_commandCount++;
+        // [len 2] [0x03] [0x16] closes a configuration sequence
+        if (frame.length == 2 && frame.payload[0] == CrestronProtocol::CONFIG_REQUEST && frame.payload[1] == 0x16) {
+            m_configuredCount++;
+        }
+        return;
+    }
+
+    m_pingCount++;
+    if (m_options.dropPercent > 0 && static_cast<uint32_t>(rand() % 100) < m_options.dropPercent) {
+        return;
+    }
+    bool flaky = frame.address >= m_options.firstAddress + m_options.slaveCount - m_options.flakySlaves;
+    if (flaky && static_cast<uint32_t>(rand() % 100) < FLAKY_DROP_PERCENT) {
+        return;
+    }
+
+    // A pty moves bytes instantly: wait out the ping's airtime, the turnaround
+    // and the reply's own airtime so the master sees its last byte when a
+    // real slave's would arrive
+    static const uint8_t pingReply[] = {0x02, 0x00};
+    static const uint8_t configRequest[] = {0x02, 0x02, CrestronProtocol::CONFIG_REQUEST, 0x00};
+    uint8_t inputChange[] = {0x02, 0x03, InboundDecoder::DIGITAL_JOIN, 0x00, 0x00};
+    const uint8_t* reply = pingReply;
+    size_t replyLength = sizeof(pingReply);
+    PendingInput& input = m_inputs[frame.address];
+    generateInputs();
+    if (m_options.requestConfig && !m_configRequested[frame.address]) {
+        m_configRequested[frame.address] = true;
+        reply = configRequest;
+        replyLength = sizeof(configRequest);
+    } else if (input.pending) {
+        inputChange[3] = input.join;
+        inputChange[4] = input.pressed ? 0x00 : InboundDecoder::JOIN_RELEASED;
+        reply = inputChange;
+        replyLength = sizeof(inputChange);
+    }
+
+    uint32_t characterUs = 11 * 1000000UL / m_options.baudRate;
+    uint32_t delayUs = 2 * characterUs + m_options.turnaroundUs + replyLength * characterUs;
+    std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+
+    if (reply == inputChange) {
+        // Published before the bytes leave, so the master never sees a stale time
+        m_reportedInputUs[frame.address] = input.changedUs;
+        input.pending = false;
+        m_reportedInputCount++;
+    }
+    if (::write(m_fd, reply, replyLength) == static_cast<ssize_t>(replyLength)) {
+        m_replyCount++;
+    }
+}
+
+void SlaveSimulator::generateInputs() {
+    if (m_options.inputsPerSecond == 0) return;
+
+    // Changes are evenly spaced in time and go to the slaves in turn
+    int64_t elapsedUs = esp_timer_get_time() - m_inputStartUs;
+    uint32_t due = static_cast<uint32_t>(elapsedUs * m_options.inputsPerSecond / 1000000);
+    for (uint32_t index = m_inputCount; index < due; index++) {
+        PendingInput& input = m_inputs[m_options.firstAddress + index % m_options.slaveCount];
+        uint32_t round = index / m_options.slaveCount;
+        input.pending = true;
+        input.join = static_cast<uint8_t>(round / 2 % 48);
+        input.pressed = round % 2 == 0;
+        input.changedUs = m_inputStartUs + static_cast<int64_t>(index) * 1000000 / m_options.inputsPerSecond;
+    }
+    if (due > m_inputCount) {
+        m_inputCount = due;
+    }
+}
+
+bool SlaveSimulator::isSimulated(uint8_t address) const {
+    return address >= m_options.firstAddress &&
+           address < m_options.firstAddress + m_options.slaveCount;
+}
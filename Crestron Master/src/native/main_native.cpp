@@ -0,0 +1,651 @@
+// Native entry point: runs the bus stack against a pty (with simulated
+// slaves) or a USB-RS485 adapter, for bring-up and soak runs off target
+#include <Arduino.h>
+#include <NativeClock.h>
+#include <esp_log.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Benchmarks.h"
+#include "config.h"
+#include "PtyTransport.h"
+#include "ReplayTransport.h"
+#include "RS485Communication.h"
+#include "SceneStore.h"
+#include "SlaveManager.h"
+#include "SlaveSimulator.h"
+#include "SlaveTable.h"
+
+static const char* TAG = "CrestronNative";
+
+namespace {
+    struct Arguments {
+        const char* device = nullptr;
+        uint32_t slaves = 8;
+        uint32_t seconds = 10;
+        uint32_t turnaroundUs = 500;
+        uint32_t dropPercent = 0;
+        uint32_t deadSlaves = 0;
+        uint32_t flakySlaves = 0;
+        uint32_t ackTimeoutMs = 0;
+        uint32_t dimsPerSecond = 0;
+        uint32_t levelsPerFrame = CrestronProtocol::DEFAULT_LEVELS_PER_FRAME;
+        bool bench = false;
+        bool config = false;
+        bool scenes = false;
+        uint32_t inputsPerSecond = 0;
+        bool discover = false;
+        const char* capturePath = nullptr;
+        const char* replayPath = nullptr;
+        const char* goldenPath = nullptr;
+    };
+
+    constexpr uint32_t SCENE_PERIOD_MS = 500;
+
+    void usage(const char* program) {
+        fprintf(stderr,
+                "usage: %s [--device PATH] [--slaves N] [--seconds S]\n"
+                "          [--turnaround US] [--drop PERCENT] [--dead N] [--flaky N] [--dims RATE]\n"
+                "          [--levels-per-frame N] [--acked MS] [--config] [--scenes]\n"
+                "          [--inputs RATE] [--discover] [--capture FILE]\n"
+                "       %s --bench\n"
+                "       %s --replay FILE [--golden FILE] [--slaves N] [--dead N] [--config]\n"
+                "          [--discover]\n"
+                "Without --device the bus is a pty answered by N simulated slaves;\n"
+                "--dead adds N more configured slaves that never answer; --flaky makes\n"
+                "the last N live slaves miss %u%% of their pings; --dims posts\n"
+                "RATE dimmer level changes per second across the live slaves;\n"
+                "--acked sends them acknowledged, each with an MS ms deadline;\n"
+                "--config has every live slave request configuration on its first poll;\n"
+                "--scenes recalls stored all-on/all-off scenes (up to 8 slaves x 8\n"
+                "channels) every %u ms or as each finishes, each one twice, instead of\n"
+                "the --dims sweep;\n"
+                "--inputs has the live slaves report RATE input changes per second;\n"
+                "--discover registers only every other live slave and finds the rest;\n"
+                "--capture writes a bus capture of the run to FILE.\n"
+                "--bench checks and times the frame parser, times the TX frame hand-off\n"
+                "and the slave table's per-ping bookkeeping, and exits; it fails if a\n"
+                "parser check fails.\n"
+                "--replay runs the master on simulated time against a capture's slaves\n"
+                "(give it the slave options the capture was taken with) and prints the\n"
+                "frames on the bus and the slave table; with --golden it fails unless\n"
+                "they match FILE.\n",
+                program,
+                program,
+                program,
+                static_cast<unsigned>(SlaveSimulator::FLAKY_DROP_PERCENT),
+                static_cast<unsigned>(SCENE_PERIOD_MS));
+    }
+
+    bool parseArguments(int argc, char** argv, Arguments& args) {
+        for (int i = 1; i < argc; i++) {
+            const char* option = argv[i];
+            if (strcmp(option, "--bench") == 0) {
+                args.bench = true;
+                continue;
+            }
+            if (strcmp(option, "--config") == 0) {
+                args.config = true;
+                continue;
+            }
+            if (strcmp(option, "--discover") == 0) {
+                args.discover = true;
+                continue;
+            }
+            if (strcmp(option, "--scenes") == 0) {
+                args.scenes = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const char* value = argv[++i];
+
+            if (strcmp(option, "--device") == 0) {
+                args.device = value;
+            } else if (strcmp(option, "--slaves") == 0) {
+                args.slaves = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--seconds") == 0) {
+                args.seconds = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--turnaround") == 0) {
+                args.turnaroundUs = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--drop") == 0) {
+                args.dropPercent = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--dead") == 0) {
+                args.deadSlaves = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--flaky") == 0) {
+                args.flakySlaves = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--dims") == 0) {
+                args.dimsPerSecond = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--inputs") == 0) {
+                args.inputsPerSecond = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--acked") == 0) {
+                args.ackTimeoutMs = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--levels-per-frame") == 0) {
+                args.levelsPerFrame = strtoul(value, nullptr, 0);
+            } else if (strcmp(option, "--capture") == 0) {
+                args.capturePath = value;
+            } else if (strcmp(option, "--replay") == 0) {
+                args.replayPath = value;
+            } else if (strcmp(option, "--golden") == 0) {
+                args.goldenPath = value;
+            } else {
+                return false;
+            }
+        }
+        // Addresses 0x03..0xFE: 0x00 is unused and 0x02 is the to-master prefix
+        return args.slaves >= 1 && args.slaves + args.deadSlaves <= 0xFC &&
+               args.flakySlaves < args.slaves && args.dropPercent <= 100 &&
+               (!args.goldenPath || args.replayPath) &&
+               (!args.replayPath || (!args.device && !args.capturePath && !args.dimsPerSecond && !args.scenes));
+    }
+
+    // Every channel of up to eight live slaves at one level
+    void buildScene(SceneStore::Scene& scene, const char* name, uint8_t firstAddress,
+                    uint32_t slaves, uint8_t level) {
+        strncpy(scene.name, name, sizeof(scene.name) - 1);
+        scene.name[sizeof(scene.name) - 1] = '\0';
+        scene.count = 0;
+        for (uint32_t i = 0; i < slaves && i < 8; i++) {
+            for (uint8_t channel = 1; channel <= SlaveDevices::DIMMER_CHANNELS; channel++) {
+                scene.targets[scene.count++] = {static_cast<uint8_t>(firstAddress + i), channel, level, 0};
+            }
+        }
+    }
+
+    // Input change to its callback, against the simulator's record of when
+    // the slave's input changed
+    struct InputWatch {
+        const SlaveSimulator* simulator;
+        LatencyHistogram changeToCallback;
+    };
+
+    void onInputChange(const SlaveManager::InboundEvent& event, void* context) {
+        InputWatch* watch = static_cast<InputWatch*>(context);
+        int64_t changedUs = watch->simulator->getReportedInputTime(event.address);
+        if (changedUs > 0) {
+            watch->changeToCallback.record(esp_timer_get_time() - changedUs);
+        }
+    }
+
+    // Acked level outcomes, as reported to the callback
+    struct AckWatch {
+        uint32_t attempts;
+        uint32_t rejected;      // Not accepted for tracking
+    };
+
+    void onDelivery(const SlaveManager::DeliveryReport& report, void* context) {
+        static_cast<AckWatch*>(context)->attempts += report.attempts;
+    }
+
+    constexpr uint8_t FIRST_ADDRESS = 0x03;
+
+    // Live slaves, then dead ones, from FIRST_ADDRESS on
+    void registerSlaves(SlaveManager& slaveManager, const Arguments& args) {
+        for (uint32_t i = 0; i < args.slaves + args.deadSlaves; i++) {
+            if (args.discover && i < args.slaves && i % 2) {
+                continue;
+            }
+            
+            // Configuration runs mix both dimmer sequences
+            SlaveManager::SlaveType type = (args.config && i % 2) ? SlaveManager::SlaveType::DIMU8
+                                                                   : SlaveManager::SlaveType::DIM8;
+            slaveManager.addSlave(static_cast<uint8_t>(FIRST_ADDRESS + i), type);
+        }
+        slaveManager.enableDiscovery(args.discover);
+    }
+
+    const char* stateName(SlaveManager::SlaveState state) {
+        switch (state) {
+            case SlaveManager::SlaveState::OFFLINE:             return "offline";
+            case SlaveManager::SlaveState::PING_SENT:           return "ping-sent";
+            case SlaveManager::SlaveState::ONLINE:              return "online";
+            case SlaveManager::SlaveState::CONFIG_REQUESTED:    return "config-requested";
+            case SlaveManager::SlaveState::CONFIGURING:         return "configuring";
+            case SlaveManager::SlaveState::CONFIGURED:          return "configured";
+            case SlaveManager::SlaveState::ERROR:
+            default:                                            return "error";
+        }
+    }
+
+    const char* typeName(SlaveManager::SlaveType type) {
+        switch (type) {
+            case SlaveManager::SlaveType::IO_48:    return "IO-48";
+            case SlaveManager::SlaveType::DIM8:     return "DIM8";
+            case SlaveManager::SlaveType::DIMU8:    return "DIMU8";
+            case SlaveManager::SlaveType::UNKNOWN:
+            default:                                return "unknown";
+        }
+    }
+
+    // Replay runs on past the capture's span by this much at most, in case
+    // the master polls less often than the recorded one did
+    constexpr uint32_t REPLAY_MARGIN_US = 1000000;
+    constexpr uint32_t REPLAY_SETTLE_MS = 100;
+
+    // The replay's output: the bus traffic with simulated times, then the
+    // slave table
+    std::vector<std::string> describeReplay(const ReplayTransport& transport, const SlaveManager& slaveManager) {
+        std::vector<std::string> lines;
+        char line[32 + 3 * 256];
+        for (const ReplayTransport::LogEntry& entry : transport.getLog()) {
+            int offset = snprintf(line, sizeof(line), "%9lld %s", static_cast<long long>(entry.timestampUs),
+                                  entry.received ? "rx" : "tx");
+            for (uint8_t byte : entry.data) {
+                offset += snprintf(line + offset, sizeof(line) - offset, " %02x", byte);
+            }
+            if (entry.lineBreak) {
+                snprintf(line + offset, sizeof(line) - offset, " break");
+            }
+            lines.push_back(line);
+        }
+
+        static SlaveManager::PollStats stats[SlaveTable<SlaveManager::SlaveInfo>::CAPACITY];
+        size_t count = slaveManager.getPollStats(stats, SlaveTable<SlaveManager::SlaveInfo>::CAPACITY);
+        lines.push_back("slave state            type     step  polls  missed");
+        for (size_t i = 0; i < count; i++) {
+            const SlaveManager::PollStats& slave = stats[i];
+            snprintf(line, sizeof(line), "0x%02x  %-16s %-7s %5u %6u %7u", slave.address, stateName(slave.state),
+                     typeName(slave.type), static_cast<unsigned>(slave.configStepIndex),
+                     static_cast<unsigned>(slave.pollCount), static_cast<unsigned>(slave.errorCount));
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    bool readLines(const char* path, std::vector<std::string>& lines) {
+        FILE* file = fopen(path, "r");
+        if (!file) {
+            fprintf(stderr, "replay: cannot open %s\n", path);
+            return false;
+        }
+        char line[32 + 3 * 256];
+        while (fgets(line, sizeof(line), file)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            lines.push_back(line);
+        }
+        fclose(file);
+        return true;
+    }
+
+    // Runs RS485Communication and SlaveManager against the capture's slaves
+    // on simulated time, until one of them has no recorded answers left
+    int runReplay(const Arguments& args) {
+        NativeClock::useVirtualTime();
+        NativeClock::attachThread();
+
+        static ReplayTransport transport;
+        if (!transport.load(args.replayPath)) {
+            return 1;
+        }
+
+        BusSettings settings = RS485Config::BUSES[0];
+        settings.name = "replay";
+        static RS485Communication rs485(transport, settings);
+        static SlaveManager slaveManager(rs485);
+        if (!rs485.initialize() || !slaveManager.initialize()) {
+            ESP_LOGE(TAG, "Failed to initialize the bus stack");
+            return 1;
+        }
+        registerSlaves(slaveManager, args);
+
+        const auto started = std::chrono::steady_clock::now();
+        const int64_t startUs = esp_timer_get_time();
+        const int64_t endUs = startUs + transport.getSpanUs() + REPLAY_MARGIN_US;
+        slaveManager.enablePinging(true);
+        while (!transport.isExhausted() && transport.getRemainingExchanges() > 0 && esp_timer_get_time() < endUs) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        slaveManager.enablePinging(false);
+        vTaskDelay(pdMS_TO_TICKS(REPLAY_SETTLE_MS));
+        const int64_t simulatedUs = esp_timer_get_time() - startUs;
+        const double realSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::vector<std::string> lines = describeReplay(transport, slaveManager);
+        const size_t frames = transport.getLog().size();
+
+        // Without a golden file the lines are the output, so the summary
+        // goes to stderr out of their way
+        FILE* report = args.goldenPath ? stdout : stderr;
+        bool passed = true;
+        if (args.goldenPath) {
+            std::vector<std::string> golden;
+            if (!readLines(args.goldenPath, golden)) {
+                return 1;
+            }
+            auto mismatch = std::mismatch(lines.begin(), lines.end(), golden.begin(), golden.end());
+            passed = mismatch.first == lines.end() && mismatch.second == golden.end();
+            if (passed) {
+                printf("replay: %u lines match %s\n", static_cast<unsigned>(golden.size()), args.goldenPath);
+            } else {
+                printf("FAIL replay: line %u differs from %s\n",
+                       static_cast<unsigned>(mismatch.first - lines.begin() + 1), args.goldenPath);
+                printf("     want %s\n", mismatch.second != golden.end() ? mismatch.second->c_str() : "(end)");
+                printf("     got  %s\n", mismatch.first != lines.end() ? mismatch.first->c_str() : "(end)");
+            }
+        } else {
+            for (const std::string& line : lines) printf("%s\n", line.c_str());
+        }
+
+        fprintf(report, "replay: %u of %u recorded polls answered, %u records (%u after other frames, not replayed)\n",
+                static_cast<unsigned>(transport.getExchangeCount() - transport.getRemainingExchanges()),
+                static_cast<unsigned>(transport.getExchangeCount()), static_cast<unsigned>(transport.getRecordCount()),
+                static_cast<unsigned>(transport.getUnattributedCount()));
+        fprintf(report, "replay: %u frames in %.0f ms simulated, %.0f ms real; %.0f frames/s, %.0fx real time\n",
+                static_cast<unsigned>(frames), simulatedUs / 1000.0, realSeconds * 1000, frames / realSeconds,
+                simulatedUs / 1e6 / realSeconds);
+        fflush(stdout);
+        fflush(stderr);
+
+        // Bus tasks cannot be torn down from outside on the shim; leave directly
+        _exit(passed ? 0 : 1);
+    }
+}
+
+int main(int argc, char** argv) {
+    Arguments args;
+    if (!parseArguments(argc, argv, args)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (args.bench) {
+        return Benchmarks::run() ? 0 : 1;
+    }
+    if (args.replayPath) {
+        return runReplay(args);
+    }
+
+    BusSettings settings = RS485Config::BUSES[0];
+    settings.name = args.device ? "serial" : "pty";
+
+    PtyTransport transport(args.device);
+    RS485Communication rs485(transport, settings);
+    SlaveManager slaveManager(rs485);
+    SlaveSimulator simulator;
+
+    if (!rs485.initialize()) {
+        ESP_LOGE(TAG, "Failed to initialize bus");
+        return 1;
+    }
+
+    const uint8_t firstAddress = FIRST_ADDRESS;
+    if (!args.device) {
+        SlaveSimulator::Options options = {firstAddress, static_cast<uint8_t>(args.slaves),
+                                           settings.baudRate, args.turnaroundUs, static_cast<uint8_t>(args.dropPercent),
+                                           args.config, args.inputsPerSecond, static_cast<uint8_t>(args.flakySlaves)};
+        if (!simulator.start(transport.peerPath(), options)) {
+            return 1;
+        }
+    }
+
+    if (!slaveManager.initialize()) {
+        ESP_LOGE(TAG, "Failed to initialize slave manager");
+        return 1;
+    }
+
+    static InputWatch inputWatch;
+    static AckWatch ackWatch;
+    inputWatch.simulator = &simulator;
+    if (args.inputsPerSecond) {
+        slaveManager.subscribe(SlaveManager::InboundEventType::INPUT_CHANGE, onInputChange, &inputWatch);
+    }
+
+    slaveManager.setMaxLevelsPerFrame(args.levelsPerFrame);
+    registerSlaves(slaveManager, args);
+    if (args.capturePath && !rs485.enableCapture(true)) {
+        return 1;
+    }
+    slaveManager.enablePinging(true);
+
+    // Scene recalls, summed as each one finishes
+    uint32_t recalls = 0, recallLevels = 0, recallSkipped = 0, recallTruncated = 0, recallFrames = 0, recallIncomplete = 0;
+
+    ESP_LOGI(TAG, "Running %u s on %s", static_cast<unsigned>(args.seconds), transport.peerPath());
+    if (args.scenes) {
+        // Stored and read back, as the firmware does from NVS
+        static SceneStore store;
+        static SceneStore::Scene scene;
+        store.begin();
+        buildScene(scene, "all on", firstAddress, args.slaves, 255);
+        store.save(scene);
+        buildScene(scene, "all off", firstAddress, args.slaves, 0);
+        store.save(scene);
+
+        // On, on again (nothing to send), off, off again
+        static const char* const cycle[] = {"all on", "all on", "all off", "all off"};
+        // A recall is given the period or, when it needs longer (one level
+        // per frame), until it finishes, so the next one cannot supersede it
+        const TickType_t end = xTaskGetTickCount() + pdMS_TO_TICKS(args.seconds * 1000);
+        for (uint32_t period = 0; xTaskGetTickCount() < end; period++) {
+            store.get(cycle[period % 4], scene);
+            uint32_t finished = slaveManager.getFinishedRecallCount();
+            TickType_t start = xTaskGetTickCount();
+            slaveManager.recallScene(scene);
+            vTaskDelay(pdMS_TO_TICKS(SCENE_PERIOD_MS));
+            while (slaveManager.getFinishedRecallCount() == finished &&
+                   xTaskGetTickCount() - start < pdMS_TO_TICKS(SceneConfig::RECALL_TIMEOUT_MS + SCENE_PERIOD_MS)) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+
+            SlaveManager::SceneRecallStats recall;
+            if (slaveManager.getLastSceneRecall(recall)) {
+                recalls++;
+                recallLevels += recall.levels;
+                recallSkipped += recall.skipped;
+                recallTruncated += recall.truncated;
+                recallFrames += recall.frames;
+                recallIncomplete += recall.complete ? 0 : 1;
+            }
+        }
+    } else if (args.dimsPerSecond == 0) {
+        vTaskDelay(pdMS_TO_TICKS(args.seconds * 1000));
+    } else {
+        // Sweep channels 1 to 8 of each live slave in turn, like a fader
+        // bank, spreading the changes evenly over each millisecond
+        uint32_t posted = 0;
+        TickType_t lastWake = xTaskGetTickCount();
+        for (uint32_t ms = 1; ms <= args.seconds * 1000; ms++) {
+            uint32_t target = static_cast<uint32_t>(static_cast<uint64_t>(args.dimsPerSecond) * ms / 1000);
+            for (; posted < target; posted++) {
+                uint8_t address = static_cast<uint8_t>(firstAddress + (posted / 8) % args.slaves);
+                uint8_t channel = static_cast<uint8_t>(1 + posted % 8);
+                if (args.ackTimeoutMs == 0) {
+                    slaveManager.sendDimCommand(address, channel, static_cast<uint8_t>(posted), 0);
+                } else if (!slaveManager.sendDimCommandAcked(address, channel, static_cast<uint8_t>(posted), 0,
+                                                             args.ackTimeoutMs, onDelivery, &ackWatch)) {
+                    ackWatch.rejected++;
+                }
+            }
+            vTaskDelayUntil(&lastWake, 1);
+        }
+        
+        // Let the last acked levels settle while polls still run
+        if (args.ackTimeoutMs) {
+            vTaskDelay(pdMS_TO_TICKS(args.ackTimeoutMs + 100));
+        }
+    }
+    slaveManager.enablePinging(false);
+
+    if (args.capturePath) {
+        FILE* file = fopen(args.capturePath, "wb");
+        if (!file) {
+            ESP_LOGE(TAG, "Cannot write %s", args.capturePath);
+            return 1;
+        }
+        FilePrint out(file);
+        BusCapture& capture = rs485.getCapture();
+        capture.dump(out, settings.baudRate);
+        fclose(file);
+        ESP_LOGI(TAG, "Captured %u frames to %s (%u dropped)", static_cast<unsigned>(capture.getRecordCount()),
+                 args.capturePath, static_cast<unsigned>(capture.getDroppedCount()));
+    }
+
+    LatencyHistogram::Summary turn = rs485.getTurnaroundHistogram().summarize();
+    LatencyHistogram::Summary wire = rs485.getEnqueueToWireHistogram().summarize();
+
+    printf("pings:       %u sent, %u answered, %u timeouts\n",
+           static_cast<unsigned>(slaveManager.getTotalPings()),
+           static_cast<unsigned>(slaveManager.getSuccessfulPings()),
+           static_cast<unsigned>(rs485.getTransactionTimeoutCount()));
+    printf("frames:      %u tx, %u rx (%.1f/s), %u errors\n",
+           static_cast<unsigned>(rs485.getTransmitCount()),
+           static_cast<unsigned>(rs485.getReceiveCount()),
+           args.seconds ? static_cast<double>(rs485.getReceiveCount()) / args.seconds : 0.0,
+           static_cast<unsigned>(rs485.getErrorCount()));
+    printf("replies:     %u late, %u unmatched\n",
+           static_cast<unsigned>(slaveManager.getLateReplyCount()),
+           static_cast<unsigned>(slaveManager.getUnmatchedReplyCount()));
+    uint8_t online[SlaveTable<SlaveManager::SlaveInfo>::CAPACITY];
+    printf("online:      %u of %u slaves\n",
+           static_cast<unsigned>(slaveManager.getOnlineSlaves(online, sizeof(online))),
+           static_cast<unsigned>(args.slaves));
+    printf("turnaround:  p50 %u us, p99 %u us, max %u us\n",
+           static_cast<unsigned>(turn.p50), static_cast<unsigned>(turn.p99), static_cast<unsigned>(turn.max));
+    printf("per slave:   %u turnaround histograms, %u slaves without one (%u replies)\n",
+           static_cast<unsigned>(rs485.getTurnaroundSlotCount()),
+           static_cast<unsigned>(rs485.getTurnaroundDroppedAddresses()),
+           static_cast<unsigned>(rs485.getTurnaroundDroppedCount()));
+    printf("tx latency:  p50 %u us, p99 %u us, max %u us\n",
+           static_cast<unsigned>(wire.p50), static_cast<unsigned>(wire.p99), static_cast<unsigned>(wire.max));
+
+    SlaveManager::SlotStats slots = slaveManager.getSlotStats();
+    LatencyHistogram::Summary jitter = slaveManager.getSlotJitterHistogram().summarize();
+    LatencyHistogram::Summary overrun = slaveManager.getSlotOverrunHistogram().summarize();
+    LatencyHistogram::Summary cycle = slaveManager.getCycleHistogram().summarize();
+    auto slotUse = [&slots](BusSchedule::SlotUse use) {
+        return static_cast<unsigned>(slots.uses[static_cast<size_t>(use)]);
+    };
+    printf("slots:       %u in %u us cycles, %u ended early, %u skipped, %u overruns (max %u us), %u breaks\n",
+           static_cast<unsigned>(slots.slots), static_cast<unsigned>(slots.cycleUs),
+           static_cast<unsigned>(slots.ended), static_cast<unsigned>(slots.skipped),
+           static_cast<unsigned>(slots.overruns),
+           static_cast<unsigned>(overrun.max), static_cast<unsigned>(slots.breaks));
+    printf("slot use:    %u poll, %u probe, %u command, %u config, %u idle\n",
+           slotUse(BusSchedule::SlotUse::POLL), slotUse(BusSchedule::SlotUse::PROBE),
+           slotUse(BusSchedule::SlotUse::COMMAND), slotUse(BusSchedule::SlotUse::CONFIG),
+           slotUse(BusSchedule::SlotUse::IDLE));
+    printf("slot jitter: p50 %u us, p99 %u us, max %u us\n",
+           static_cast<unsigned>(jitter.p50), static_cast<unsigned>(jitter.p99), static_cast<unsigned>(jitter.max));
+    printf("cycle:       p50 %u us, p99 %u us, max %u us\n",
+           static_cast<unsigned>(cycle.p50), static_cast<unsigned>(cycle.p99), static_cast<unsigned>(cycle.max));
+
+    // Achieved poll rate, answering slaves vs. the configured-but-dead ones
+    static SlaveManager::PollStats stats[SlaveTable<SlaveManager::SlaveInfo>::CAPACITY];
+    size_t statCount = slaveManager.getPollStats(stats, SlaveTable<SlaveManager::SlaveInfo>::CAPACITY);
+    uint32_t livePolls = 0, deadPolls = 0, flakyPolls = 0;
+    uint32_t probation = 0, healthyLatencyUs = 0, healthyBytes = 0;
+    uint16_t worstRatio = 0, flakyRatio = 0;
+    const uint32_t firstFlaky = firstAddress + args.slaves - args.flakySlaves;
+    for (size_t i = 0; i < statCount; i++) {
+        const SlaveManager::PollStats& slave = stats[i];
+        if (slave.address >= firstAddress + args.slaves) {
+            deadPolls += slave.pollCount;
+        } else if (slave.address >= firstFlaky) {
+            flakyPolls += slave.pollCount;
+            flakyRatio = std::max(flakyRatio, slave.timeoutRatio);
+        } else {
+            livePolls += slave.pollCount;
+            worstRatio = std::max(worstRatio, slave.timeoutRatio);
+            healthyLatencyUs = std::max(healthyLatencyUs, slave.latencyEwmaUs);
+            healthyBytes += slave.bytesSent + slave.bytesReceived;
+        }
+        probation += slave.onProbation ? 1 : 0;
+    }
+    if (args.dimsPerSecond) {
+        const CommandCoalescer& levels = slaveManager.getDimLevels();
+        printf("dim levels:  %u posted, %u merged, %u sent in %u frames, %u rejected\n",
+               static_cast<unsigned>(levels.getPostedCount()),
+               static_cast<unsigned>(levels.getCoalescedCount()),
+               static_cast<unsigned>(levels.getTakenCount()),
+               static_cast<unsigned>(slaveManager.getLevelFrameCount()),
+               static_cast<unsigned>(levels.getRejectedCount()));
+        printf("level rate:  %.1f channel updates/s\n",
+               static_cast<double>(levels.getTakenCount()) / args.seconds);
+        if (args.ackTimeoutMs) {
+            SlaveManager::DeliveryStats delivery = slaveManager.getDeliveryStats();
+            LatencyHistogram::Summary acked = slaveManager.getDeliveryLatencyHistogram().summarize();
+            auto outcome = [&delivery](SlaveManager::DeliveryOutcome which) {
+                return static_cast<unsigned>(delivery.outcomes[static_cast<size_t>(which)]);
+            };
+            printf("acked:       %u delivered, %u retried, %u failed, %u superseded, %u not tracked\n",
+                   outcome(SlaveManager::DeliveryOutcome::DELIVERED), outcome(SlaveManager::DeliveryOutcome::RETRIED),
+                   outcome(SlaveManager::DeliveryOutcome::FAILED), outcome(SlaveManager::DeliveryOutcome::SUPERSEDED),
+                   static_cast<unsigned>(ackWatch.rejected));
+            uint32_t reported = 0;
+            for (uint32_t count : delivery.outcomes) {
+                reported += count;
+            }
+            printf("resends:     %u levels resent, %.3f sends per reported level, %u still in flight\n",
+                   static_cast<unsigned>(delivery.resends),
+                   reported ? static_cast<double>(ackWatch.attempts) / reported : 0.0,
+                   static_cast<unsigned>(delivery.inFlight));
+            printf("ack time:    p50 %u us, p99 %u us, max %u us\n",
+                   static_cast<unsigned>(acked.p50), static_cast<unsigned>(acked.p99), static_cast<unsigned>(acked.max));
+        }
+    }
+    if (args.scenes) {
+        LatencyHistogram::Summary span = slaveManager.getSceneSpanHistogram().summarize();
+        printf("scenes:      %u recalled, %u levels in %u frames, %u skipped, %u truncated, %u incomplete\n",
+               static_cast<unsigned>(recalls), static_cast<unsigned>(recallLevels),
+               static_cast<unsigned>(recallFrames), static_cast<unsigned>(recallSkipped),
+               static_cast<unsigned>(recallTruncated), static_cast<unsigned>(recallIncomplete));
+        printf("scene span:  p50 %u us, p99 %u us, max %u us (first frame to last, %u recalls)\n",
+               static_cast<unsigned>(span.p50), static_cast<unsigned>(span.p99),
+               static_cast<unsigned>(span.max), static_cast<unsigned>(span.count));
+    }
+    if (args.inputsPerSecond) {
+        LatencyHistogram::Summary bus = slaveManager.getEventLatencyHistogram().summarize();
+        LatencyHistogram::Summary change = inputWatch.changeToCallback.summarize();
+        printf("inputs:      %u changed, %u reported, %u delivered\n",
+               static_cast<unsigned>(simulator.getInputCount()),
+               static_cast<unsigned>(simulator.getReportedInputCount()),
+               static_cast<unsigned>(slaveManager.getInboundEventCount(SlaveManager::InboundEventType::INPUT_CHANGE)));
+        printf("bus to cb:   p50 %u us, p99 %u us, max %u us\n",
+               static_cast<unsigned>(bus.p50), static_cast<unsigned>(bus.p99), static_cast<unsigned>(bus.max));
+        printf("change to cb: p50 %u us, p99 %u us, max %u us (waits for the slave's poll)\n",
+               static_cast<unsigned>(change.p50), static_cast<unsigned>(change.p99), static_cast<unsigned>(change.max));
+    }
+    if (args.discover) {
+        SlaveManager::DiscoveryStats discovery = slaveManager.getDiscoveryStats();
+        printf("discovery:   %u probes, %u of %u unregistered slaves found, %u sweeps\n",
+               static_cast<unsigned>(discovery.probes), static_cast<unsigned>(discovery.found),
+               static_cast<unsigned>(args.slaves / 2), static_cast<unsigned>(discovery.sweeps));
+        printf("sweep time:  %u ms last, %u ms projected at this load\n",
+               static_cast<unsigned>(discovery.lastSweepMs), static_cast<unsigned>(discovery.estimatedSweepMs));
+    }
+    if (args.config) {
+        printf("configured:  %u of %u slaves (%u confirmed by the simulator)\n",
+               static_cast<unsigned>(slaveManager.getConfigurationCount()),
+               static_cast<unsigned>(args.slaves),
+               static_cast<unsigned>(simulator.getConfiguredCount()));
+    }
+    uint32_t healthySlaves = args.slaves - args.flakySlaves;
+    printf("link:        %u on probation, worst healthy slave %u/%u missed, %u us smoothed latency, %u bytes each\n",
+           static_cast<unsigned>(probation), static_cast<unsigned>(worstRatio),
+           static_cast<unsigned>(LinkQuality::RATIO_SCALE), static_cast<unsigned>(healthyLatencyUs),
+           static_cast<unsigned>(healthyBytes / healthySlaves));
+    printf("poll rate:   %.2f/s per live slave", static_cast<double>(livePolls) / healthySlaves / args.seconds);
+    if (args.flakySlaves) {
+        printf(", %.2f/s per flaky slave (%u/%u missed)",
+               static_cast<double>(flakyPolls) / args.flakySlaves / args.seconds,
+               static_cast<unsigned>(flakyRatio), static_cast<unsigned>(LinkQuality::RATIO_SCALE));
+    }
+    if (args.deadSlaves) {
+        printf(", %.2f/s per dead slave", static_cast<double>(deadPolls) / args.deadSlaves / args.seconds);
+    }
+    printf("\n");
+    if (!args.device) {
+        printf("simulator:   %u pings seen, %u replies\n",
+               static_cast<unsigned>(simulator.getPingCount()),
+               static_cast<unsigned>(simulator.getReplyCount()));
+    }
+    fflush(stdout);
+
+    // Bus tasks cannot be torn down from outside on the shim; leave directly
+    _exit(0);
+}
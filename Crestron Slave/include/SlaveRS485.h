@@ -4,11 +4,13 @@
 #include <driver/uart.h>
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
+#include <RS485Port.h>
 #include "config.h"
 
 /**
  * RS485 communication handler for Crestron slave device
- * Handles precise timing for RS485 transceiver control and message processing
+ * Bus direction is switched by the UART in RS485 half-duplex mode (see RS485Port),
+ * so replies are queued to the peripheral without task-level delays
  */
 class SlaveRS485 {
 public:
@@ -55,6 +57,7 @@ private:
     static constexpr size_t TX_BUFFER_SIZE = 256;
     
     bool m_initialized;
+    RS485Port m_port;
     QueueHandle_t m_rxQueue;
     SemaphoreHandle_t m_txMutex;
     TaskHandle_t m_rxTaskHandle;
@@ -66,18 +69,10 @@ private:
     
     // Internal methods
     bool configureUART();
-    bool configureRS485Pin();
     void startReceiveTask();
     void stopReceiveTask();
     
-    // RS485 transceiver control
-    void setTransmitMode(bool enable);
-    void transmitWithTiming(const uint8_t* data, size_t length);
-    
     // Task functions
     static void rxTaskFunction(void* parameter);
     void handleReceive();
-    
-    // Timing utilities
-    void preciseDelayMicroseconds(uint32_t microseconds);
 };
\ No newline at end of file
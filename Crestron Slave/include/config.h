@@ -27,9 +27,9 @@ namespace SlaveConfig {
 
 // Protocol timing constants
 namespace ProtocolTiming {
-    constexpr uint32_t PRE_TRANSMIT_DELAY_US = 100;
-    constexpr uint32_t TRANSMIT_ENABLE_DELAY_US = 600;
-    constexpr uint32_t POST_TRANSMIT_DELAY_US = 350;
+    // Idle time the UART inserts before each reply so the master has released
+    // the bus (4 bits ~= 100us at 38400 baud); DE/RE is switched in hardware
+    constexpr uint16_t TURNAROUND_IDLE_BITS = 4;
     constexpr uint32_t RESPONSE_TIMEOUT_MS = 10;
     constexpr uint32_t DEBOUNCE_DELAY_MS = 50;
 }
@@ -1,7 +1,5 @@
 #include "SlaveRS485.h"
 #include <esp_log.h>
-#include <driver/gpio.h>
-#include <soc/uart_reg.h>
 
 static const char* TAG = "SlaveRS485";
 
@@ -43,16 +41,6 @@ bool SlaveRS485::initialize() {
         return false;
     }
 
-    // Configure RS485 direction control pin
-    if (!configureRS485Pin()) {
-        ESP_LOGE(TAG, "Failed to configure RS485 pin");
-        deinitialize();
-        return false;
-    }
-
-    // Set to receive mode initially
-    setTransmitMode(false);
-
     // Start receive task
     startReceiveTask();
 
@@ -76,53 +64,27 @@ void SlaveRS485::deinitialize() {
         m_txMutex = nullptr;
     }
 
-    uart_driver_delete(UART_PORT);
+    m_port.end();
     m_initialized = false;
     
     ESP_LOGI(TAG, "Slave RS485 deinitialized");
 }
 
 bool SlaveRS485::configureUART() {
-    uart_config_t uart_config = {
-        .baud_rate = static_cast<int>(SlaveConfig::BAUD_RATE),
-        .data_bits = SlaveConfig::DATA_BITS,
-        .parity = SlaveConfig::PARITY,
-        .stop_bits = SlaveConfig::STOP_BITS,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .rx_flow_ctrl_thresh = 0,
-        .source_clk = UART_SCLK_APB
-    };
-
-    if (uart_param_config(UART_PORT, &uart_config) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure UART parameters");
-        return false;
-    }
-
-    if (uart_set_pin(UART_PORT, SlaveConfig::RS485_TX_PIN, SlaveConfig::RS485_RX_PIN, 
-                     UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set UART pins");
-        return false;
-    }
-
-    if (uart_driver_install(UART_PORT, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 
-                           0, nullptr, 0) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to install UART driver");
-        return false;
-    }
-
-    return true;
-}
-
-bool SlaveRS485::configureRS485Pin() {
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << SlaveConfig::RS485_DE_RE_PIN),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    
-    return gpio_config(&io_conf) == ESP_OK;
+    RS485Port::Config config;
+    config.port = UART_PORT;
+    config.txPin = SlaveConfig::RS485_TX_PIN;
+    config.rxPin = SlaveConfig::RS485_RX_PIN;
+    config.dePin = SlaveConfig::RS485_DE_RE_PIN;
+    config.baudRate = SlaveConfig::BAUD_RATE;
+    config.dataBits = SlaveConfig::DATA_BITS;
+    config.parity = SlaveConfig::PARITY;
+    config.stopBits = SlaveConfig::STOP_BITS;
+    config.rxBufferSize = RX_BUFFER_SIZE;
+    config.txBufferSize = TX_BUFFER_SIZE;
+    config.txIdleBits = ProtocolTiming::TURNAROUND_IDLE_BITS;
+
+    return m_port.begin(config);
 }
 
 void SlaveRS485::startReceiveTask() {
@@ -169,9 +131,16 @@ SlaveRS485::TransmitResult SlaveRS485::sendMessage(const uint8_t* data, size_t l
     }
 
     if (xSemaphoreTake(m_txMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        transmitWithTiming(data, length);
+        // Queued to the UART; turnaround gap and DE/RE are handled in hardware
+        int bytesWritten = m_port.write(data, length);
         xSemaphoreGive(m_txMutex);
         
+        if (bytesWritten != static_cast<int>(length)) {
+            ESP_LOGW(TAG, "Incomplete transmission: %d/%d bytes", bytesWritten, static_cast<int>(length));
+            m_errorCount++;
+            return TransmitResult::ERROR;
+        }
+        
         m_transmitCount++;
         return TransmitResult::SUCCESS;
     }
@@ -180,40 +149,8 @@ SlaveRS485::TransmitResult SlaveRS485::sendMessage(const uint8_t* data, size_t l
     return TransmitResult::TIMEOUT;
 }
 
-void SlaveRS485::setTransmitMode(bool enable) {
-    gpio_set_level(static_cast<gpio_num_t>(SlaveConfig::RS485_DE_RE_PIN), enable ? 1 : 0);
-}
-
-void SlaveRS485::transmitWithTiming(const uint8_t* data, size_t length) {
-    // Pre-transmit delay
-    preciseDelayMicroseconds(ProtocolTiming::PRE_TRANSMIT_DELAY_US);
-    
-    // Enable transmitter
-    setTransmitMode(true);
-    
-    // Wait for transmitter to be ready
-    preciseDelayMicroseconds(ProtocolTiming::TRANSMIT_ENABLE_DELAY_US);
-    
-    // Send the data
-    int bytesWritten = uart_write_bytes(UART_PORT, data, length);
-    
-    // Wait for transmission to complete
-    uart_wait_tx_done(UART_PORT, pdMS_TO_TICKS(50));
-    
-    // Post-transmit delay before disabling transmitter
-    preciseDelayMicroseconds(ProtocolTiming::POST_TRANSMIT_DELAY_US);
-    
-    // Disable transmitter (enable receiver)
-    setTransmitMode(false);
-    
-    if (bytesWritten != length) {
-        ESP_LOGW(TAG, "Incomplete transmission: %d/%d bytes", bytesWritten, length);
-        m_errorCount++;
-    }
-}
-
 void SlaveRS485::flushBuffers() {
-    uart_flush(UART_PORT);
+    m_port.flushInput();
     
     if (m_rxQueue) {
         xQueueReset(m_rxQueue);
@@ -231,7 +168,7 @@ void SlaveRS485::handleReceive() {
     uint8_t buffer[Protocol::MAX_MESSAGE_LENGTH];
     
     while (true) {
-        int length = uart_read_bytes(UART_PORT, buffer, sizeof(buffer), pdMS_TO_TICKS(100));
+        int length = m_port.read(buffer, sizeof(buffer), pdMS_TO_TICKS(100));
         
         if (length > 0) {
             message.length = length;
@@ -249,11 +186,3 @@ void SlaveRS485::handleReceive() {
         }
     }
 }
-
-void SlaveRS485::preciseDelayMicroseconds(uint32_t microseconds) {
-    if (microseconds < 1000) {
-        delayMicroseconds(microseconds);
-    } else {
-        vTaskDelay(pdMS_TO_TICKS(microseconds / 1000));
-    }
-}
\ No newline at end of file
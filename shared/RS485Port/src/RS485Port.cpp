@@ -0,0 +1,149 @@
+#include "RS485Port.h"
+#include <esp_log.h>
+
+static const char* TAG = "RS485Port";
+
+RS485Port::RS485Port()
+    : m_eventQueue(nullptr)
+    , m_open(false)
+{
+}
+
+RS485Port::~RS485Port() {
+    end();
+}
+
+bool RS485Port::begin(const Config& config) {
+    if (m_open) {
+        ESP_LOGW(TAG, "UART%d already open", m_config.port);
+        return true;
+    }
+
+    m_config = config;
+
+    uart_config_t uart_config = {
+        .baud_rate = static_cast<int>(config.baudRate),
+        .data_bits = config.dataBits,
+        .parity = config.parity,
+        .stop_bits = config.stopBits,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .rx_flow_ctrl_thresh = 0,
+        .source_clk = UART_SCLK_APB
+    };
+
+    if (uart_driver_install(config.port, config.rxBufferSize, config.txBufferSize,
+                            config.eventQueueSize,
+                            config.eventQueueSize > 0 ? &m_eventQueue : nullptr, 0) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install UART%d driver", config.port);
+        return false;
+    }
+
+    m_open = true;
+
+    if (uart_param_config(config.port, &uart_config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure UART%d parameters", config.port);
+        end();
+        return false;
+    }
+
+    // RTS doubles as the transceiver's DE/RE line in RS485 half-duplex mode
+    if (uart_set_pin(config.port, config.txPin, config.rxPin,
+                     config.dePin, UART_PIN_NO_CHANGE) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set UART%d pins", config.port);
+        end();
+        return false;
+    }
+
+    if (uart_set_mode(config.port, UART_MODE_RS485_HALF_DUPLEX) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable RS485 half-duplex mode on UART%d", config.port);
+        end();
+        return false;
+    }
+
+    if (config.rxTimeoutSymbols > 0 &&
+        uart_set_rx_timeout(config.port, config.rxTimeoutSymbols) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set UART%d RX timeout", config.port);
+        end();
+        return false;
+    }
+
+    if (config.txIdleBits > 0 &&
+        uart_set_tx_idle_num(config.port, config.txIdleBits) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set UART%d TX idle time", config.port);
+        end();
+        return false;
+    }
+
+    ESP_LOGI(TAG, "UART%d open in RS485 half-duplex mode at %u baud",
+             config.port, static_cast<unsigned>(config.baudRate));
+    return true;
+}
+
+void RS485Port::end() {
+    if (!m_open) return;
+
+    uart_driver_delete(m_config.port);
+    m_eventQueue = nullptr; // Owned and freed by the UART driver
+    m_open = false;
+}
+
+int RS485Port::write(const uint8_t* data, size_t length) {
+    if (!m_open || !data || length == 0) {
+        return -1;
+    }
+
+    // Copies into the driver's TX ring buffer; the UART drives DE for the frame
+    return uart_write_bytes(m_config.port, data, length);
+}
+
+int RS485Port::writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits) {
+    if (!m_open || !data || length == 0 || breakBits == 0) {
+        return -1;
+    }
+
+    // The UART holds the line low for breakBits bit times after the data
+    return uart_write_bytes_with_break(m_config.port, data, length, breakBits);
+}
+
+bool RS485Port::waitTxDone(TickType_t timeout) {
+    return m_open && uart_wait_tx_done(m_config.port, timeout) == ESP_OK;
+}
+
+bool RS485Port::collisionDetected() {
+    bool collision = false;
+    if (m_open) {
+        uart_get_collision_flag(m_config.port, &collision);
+    }
+    return collision;
+}
+
+int RS485Port::read(uint8_t* buffer, size_t length, TickType_t timeout) {
+    if (!m_open || !buffer || length == 0) {
+        return -1;
+    }
+
+    return uart_read_bytes(m_config.port, buffer, length, timeout);
+}
+
+size_t RS485Port::available() const {
+    size_t length = 0;
+    if (m_open) {
+        uart_get_buffered_data_len(m_config.port, &length);
+    }
+    return length;
+}
+
+void RS485Port::flushInput() {
+    if (m_open) {
+        uart_flush_input(m_config.port);
+    }
+}
+
+uint32_t RS485Port::characterTimeUs() const {
+    // Start bit + data bits + parity + stop bits
+    uint32_t bits = 1 + 5 + static_cast<uint32_t>(m_config.dataBits);
+    if (m_config.parity != UART_PARITY_DISABLE) bits += 1;
+    bits += (m_config.stopBits == UART_STOP_BITS_1) ? 1 : 2;
+
+    return (bits * 1000000UL + m_config.baudRate - 1) / m_config.baudRate;
+}
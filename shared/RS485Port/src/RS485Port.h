@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include <driver/uart.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+/**
+ * Shared RS485 port driver for the ESP32 UART peripheral
+ *
+ * Runs the UART in UART_MODE_RS485_HALF_DUPLEX with the transceiver's DE/RE
+ * line wired to the UART RTS output, so the peripheral asserts the driver
+ * exactly while bytes are on the wire and releases it after the last stop
+ * bit. Transmission only copies into the driver's TX ring buffer and never
+ * waits for the bus; callers that need end-of-frame timing use waitTxDone().
+ */
+class RS485Port {
+public:
+    struct Config {
+        uart_port_t port = UART_NUM_2;
+        int txPin = UART_PIN_NO_CHANGE;
+        int rxPin = UART_PIN_NO_CHANGE;
+        int dePin = UART_PIN_NO_CHANGE;      // Driven by the UART as RTS
+        uint32_t baudRate = 115200;
+        uart_word_length_t dataBits = UART_DATA_8_BITS;
+        uart_parity_t parity = UART_PARITY_DISABLE;
+        uart_stop_bits_t stopBits = UART_STOP_BITS_1;
+        size_t rxBufferSize = 512;
+        size_t txBufferSize = 256;           // Must be non-zero for non-blocking writes
+        int eventQueueSize = 0;              // 0 = no UART event queue
+        uint8_t rxTimeoutSymbols = 0;        // 0 = keep driver default
+        uint16_t txIdleBits = 0;             // Bus turnaround before each frame, 0 = driver default
+    };
+
+    RS485Port();
+    ~RS485Port();
+
+    bool begin(const Config& config);
+    void end();
+    
+    // Transmission (non-blocking)
+    int write(const uint8_t* data, size_t length);
+    int writeWithBreak(const uint8_t* data, size_t length, uint8_t breakBits);
+    bool waitTxDone(TickType_t timeout);
+    bool collisionDetected();  // Clash flag latched by the UART during the last transmission
+    
+    // Reception
+    int read(uint8_t* buffer, size_t length, TickType_t timeout);
+    size_t available() const;
+    void flushInput();
+    
+    // Accessors
+    bool isOpen() const { return m_open; }
+    uart_port_t port() const { return m_config.port; }
+    QueueHandle_t eventQueue() const { return m_eventQueue; }
+    uint32_t characterTimeUs() const;
+
+private:
+    Config m_config;
+    QueueHandle_t m_eventQueue;
+    bool m_open;
+};